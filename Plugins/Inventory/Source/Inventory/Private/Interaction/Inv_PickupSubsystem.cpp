@@ -0,0 +1,271 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Interaction/Inv_PickupSubsystem.h"
+
+#include "Inventory.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Items/Components/Inv_ItemComponent.h"
+#include "Player/Inv_PlayerController.h"
+
+void UInv_PickupSubsystem::Deinitialize()
+{
+	Cells.Empty();
+	PickupCells.Empty();
+	CellVersions.Empty();
+	Scanners.Empty();
+
+	Super::Deinitialize();
+}
+
+void UInv_PickupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Scanners.IsEmpty()) return;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double ScanInterval = ScanRate > 0.f ? 1.0 / ScanRate : 0.0;
+	const int32 NumScanners = Scanners.Num();
+
+	int32 NumScans = 0;
+	for (int32 Step = 0; Step < NumScanners && NumScans < MaxScansPerFrame; ++Step)
+	{
+		const int32 Index = (NextScanner + Step) % NumScanners;
+		FScanner& Scanner = Scanners[Index];
+		if (Now < Scanner.NextScanTime) continue;
+
+		AInv_PlayerController* Controller = Scanner.Controller.Get();
+		if (!IsValid(Controller)) continue;
+
+		Scanner.NextScanTime = Now + ScanInterval;
+		NextScanner = (Index + 1) % NumScanners;
+
+		if (Controller->IsInventoryMenuOpen())
+		{
+			INC_DWORD_STAT(STAT_Inv_PickupScansSkipped);
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		if (Scanner.bHasScanned &&
+			FVector::DistSquared(ViewLocation, Scanner.LastViewLocation) < FMath::Square(MinViewLocationDelta) &&
+			ViewRotation.Equals(Scanner.LastViewRotation, MinViewRotationDelta) &&
+			!HaveCellsChanged(Scanner))
+		{
+			INC_DWORD_STAT(STAT_Inv_PickupScansSkipped);
+			continue;
+		}
+
+		Scanner.bHasScanned = true;
+		Scanner.LastViewLocation = ViewLocation;
+		Scanner.LastViewRotation = ViewRotation;
+
+		LastQueriedCells = FIntRect();
+		Controller->TraceForItem(ViewLocation, ViewRotation);
+		SnapshotCellVersions(Scanner, LastQueriedCells);
+		++NumScans;
+		INC_DWORD_STAT(STAT_Inv_PickupScans);
+	}
+}
+
+TStatId UInv_PickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UInv_PickupSubsystem, STATGROUP_Tickables);
+}
+
+UInv_PickupSubsystem* UInv_PickupSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine
+		                      ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull)
+		                      : nullptr;
+	return World ? World->GetSubsystem<UInv_PickupSubsystem>() : nullptr;
+}
+
+void UInv_PickupSubsystem::RegisterPickup(UInv_ItemComponent* ItemComponent)
+{
+	if (!IsValid(ItemComponent) || !IsValid(ItemComponent->GetOwner())) return;
+	if (PickupCells.Contains(ItemComponent)) return;
+
+	const FVector TargetLocation = GetTargetLocation(ItemComponent->GetOwner());
+	const FIntPoint Cell = GetCell(TargetLocation);
+	Cells.FindOrAdd(Cell).Add({ItemComponent, TargetLocation});
+	PickupCells.Add(ItemComponent, Cell);
+	TouchCell(Cell);
+}
+
+void UInv_PickupSubsystem::UnregisterPickup(UInv_ItemComponent* ItemComponent)
+{
+	FIntPoint Cell;
+	if (!PickupCells.RemoveAndCopyValue(ItemComponent, Cell)) return;
+	TouchCell(Cell);
+
+	if (TArray<FIndexedPickup>* Pickups = Cells.Find(Cell))
+	{
+		Pickups->RemoveAllSwap([ItemComponent](const FIndexedPickup& Pickup)
+		{
+			return Pickup.ItemComponent == ItemComponent;
+		});
+		if (Pickups->IsEmpty())
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void UInv_PickupSubsystem::UpdatePickup(UInv_ItemComponent* ItemComponent)
+{
+	const FIntPoint* OldCell = PickupCells.Find(ItemComponent);
+	if (!OldCell || !IsValid(ItemComponent->GetOwner())) return;
+
+	const FVector TargetLocation = GetTargetLocation(ItemComponent->GetOwner());
+	if (GetCell(TargetLocation) != *OldCell)
+	{
+		UnregisterPickup(ItemComponent);
+		RegisterPickup(ItemComponent);
+		return;
+	}
+
+	// 格子内的移动也可能让 Pickup 进出视锥
+	TouchCell(*OldCell);
+	for (FIndexedPickup& Pickup : Cells.FindChecked(*OldCell))
+	{
+		if (Pickup.ItemComponent == ItemComponent)
+		{
+			Pickup.TargetLocation = TargetLocation;
+			break;
+		}
+	}
+}
+
+void UInv_PickupSubsystem::FindPickupsInView(const FVector& ViewLocation, const FVector& ViewDirection,
+                                             const float MaxDistance, const float ConeHalfAngle,
+                                             TArray<FInv_PickupCandidate>& OutCandidates) const
+{
+	OutCandidates.Reset();
+	if (MaxDistance <= 0.f) return;
+
+	const float HalfAngleRadians = FMath::DegreesToRadians(FMath::Clamp(ConeHalfAngle, 0.f, 89.f));
+	const float MinViewDot = FMath::Cos(HalfAngleRadians);
+	const float ViewDotRange = FMath::Max(1.f - MinViewDot, UE_KINDA_SMALL_NUMBER);
+
+	// 视锥的包围盒：视点到视锥末端，再按末端的半径扩大
+	FBox ViewBounds(ViewLocation, ViewLocation + ViewDirection * MaxDistance);
+	ViewBounds = FBox(ViewBounds.Min.ComponentMin(ViewBounds.Max), ViewBounds.Min.ComponentMax(ViewBounds.Max))
+		.ExpandBy(MaxDistance * FMath::Sin(HalfAngleRadians));
+
+	const FIntPoint MinCell = GetCell(ViewBounds.Min);
+	const FIntPoint MaxCell = GetCell(ViewBounds.Max);
+	// 即使现在没有任何 Pickup 也要记下范围，之后有 Pickup 进入这些格子时 Scanner 才会重新查找
+	LastQueriedCells = FIntRect(MinCell, MaxCell);
+	if (Cells.IsEmpty()) return;
+
+	for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+	{
+		for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+		{
+			const TArray<FIndexedPickup>* Pickups = Cells.Find(FIntPoint(CellX, CellY));
+			if (!Pickups) continue;
+
+			for (const FIndexedPickup& Pickup : *Pickups)
+			{
+				if (!Pickup.ItemComponent.IsValid() || !IsValid(Pickup.ItemComponent->GetOwner())) continue;
+
+				const FVector ToPickup = Pickup.TargetLocation - ViewLocation;
+				const float Distance = ToPickup.Size();
+				if (Distance > MaxDistance) continue;
+
+				const float ViewDot = Distance > UE_KINDA_SMALL_NUMBER
+					                      ? FVector::DotProduct(ToPickup, ViewDirection) / Distance
+					                      : 1.f;
+				if (ViewDot < MinViewDot) continue;
+
+				// 角度和距离都归一化到 [0, 1]：准星正对但很远的 Pickup 不会总是压过稍微偏一点但就在脚边的
+				const float Score = (1.f - ViewDot) / ViewDotRange + DistanceWeight * Distance / MaxDistance;
+				OutCandidates.Add({Pickup.ItemComponent.Get(), Pickup.TargetLocation, ViewDot, Distance, Score});
+			}
+		}
+	}
+
+	OutCandidates.Sort([](const FInv_PickupCandidate& A, const FInv_PickupCandidate& B)
+	{
+		return A.Score < B.Score;
+	});
+}
+
+FVector UInv_PickupSubsystem::GetTargetLocation(const AActor* Pickup)
+{
+	FVector BoundsOrigin;
+	FVector BoundsExtent;
+	Pickup->GetActorBounds(true, BoundsOrigin, BoundsExtent);
+	return BoundsExtent.IsNearlyZero() ? Pickup->GetActorLocation() : BoundsOrigin;
+}
+
+void UInv_PickupSubsystem::RegisterScanner(AInv_PlayerController* Controller)
+{
+	if (!IsValid(Controller)) return;
+	const bool bRegistered = Scanners.ContainsByPredicate([Controller](const FScanner& Scanner)
+	{
+		return Scanner.Controller == Controller;
+	});
+	if (bRegistered) return;
+
+	FScanner& Scanner = Scanners.AddDefaulted_GetRef();
+	Scanner.Controller = Controller;
+}
+
+void UInv_PickupSubsystem::UnregisterScanner(AInv_PlayerController* Controller)
+{
+	Scanners.RemoveAll([Controller](const FScanner& Scanner)
+	{
+		return !Scanner.Controller.IsValid() || Scanner.Controller == Controller;
+	});
+	NextScanner = Scanners.IsEmpty() ? 0 : NextScanner % Scanners.Num();
+}
+
+FIntPoint UInv_PickupSubsystem::GetCell(const FVector& Location) const
+{
+	const float Size = FMath::Max(CellSize, 1.f);
+	return FIntPoint(FMath::FloorToInt32(Location.X / Size), FMath::FloorToInt32(Location.Y / Size));
+}
+
+void UInv_PickupSubsystem::TouchCell(const FIntPoint& Cell)
+{
+	CellVersions.FindOrAdd(Cell) = ++LastCellVersion;
+}
+
+void UInv_PickupSubsystem::SnapshotCellVersions(FScanner& Scanner, const FIntRect& QueriedCells) const
+{
+	// 视点的变化小于阈值时视锥的包围盒最多跨进相邻的格子，所以向外多记一圈
+	Scanner.LastCells = FIntRect(QueriedCells.Min - FIntPoint(1, 1), QueriedCells.Max + FIntPoint(1, 1));
+	Scanner.LastCellVersions.Reset();
+	for (int32 CellY = Scanner.LastCells.Min.Y; CellY <= Scanner.LastCells.Max.Y; ++CellY)
+	{
+		for (int32 CellX = Scanner.LastCells.Min.X; CellX <= Scanner.LastCells.Max.X; ++CellX)
+		{
+			Scanner.LastCellVersions.Add(CellVersions.FindRef(FIntPoint(CellX, CellY)));
+		}
+	}
+}
+
+bool UInv_PickupSubsystem::HaveCellsChanged(const FScanner& Scanner) const
+{
+	int32 Index = 0;
+	for (int32 CellY = Scanner.LastCells.Min.Y; CellY <= Scanner.LastCells.Max.Y; ++CellY)
+	{
+		for (int32 CellX = Scanner.LastCells.Min.X; CellX <= Scanner.LastCells.Max.X; ++CellX)
+		{
+			if (!Scanner.LastCellVersions.IsValidIndex(Index) ||
+				CellVersions.FindRef(FIntPoint(CellX, CellY)) != Scanner.LastCellVersions[Index])
+			{
+				return true;
+			}
+			++Index;
+		}
+	}
+	return false;
+}
@@ -6,6 +6,16 @@
 
 DEFINE_LOG_CATEGORY(LogInventory);
 
+DEFINE_STAT(STAT_Inv_ActiveSlottedItems);
+DEFINE_STAT(STAT_Inv_SlottedItemsCreated);
+DEFINE_STAT(STAT_Inv_HoverItemsCreated);
+DEFINE_STAT(STAT_Inv_InvalidatedWidgets);
+DEFINE_STAT(STAT_Inv_LayoutInvalidations);
+DEFINE_STAT(STAT_Inv_PickupScans);
+DEFINE_STAT(STAT_Inv_PickupScansSkipped);
+DEFINE_STAT(STAT_Inv_OcclusionTraces);
+DEFINE_STAT(STAT_Inv_ManifestCopies);
+
 void FInventoryModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
@@ -3,10 +3,13 @@
 
 #include "InventoryManagement/Components/Inv_InventoryComponent.h"
 
+#include "Inventory.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Net/NetworkSubsystem.h"
 #include "Items/Components/Inv_ItemComponent.h"
-#include "Items/Inv_InventoryItem.h"
 #include "Items/Fragments/Inv_ItemFragment.h"
+#include "GameFramework/Pawn.h"
 #include "Widgets/Inventory/InventoryBase/Inv_InventoryBase.h"
 
 
@@ -26,71 +29,451 @@ UInv_InventoryComponent::UInv_InventoryComponent() : InventoryList(this)
 	bReplicateUsingRegisteredSubObjectList = true;
 
 	bInventoryMenuOpen = false;
+
+	// 与 WBP_Inv_InventoryGrid 中原来保存的 Rows = 4、Columns = 8 一致
+	GridSizes.Add(EInv_ItemCategory::Equippable, FIntPoint(8, 4));
+	GridSizes.Add(EInv_ItemCategory::Consumable, FIntPoint(8, 4));
+	GridSizes.Add(EInv_ItemCategory::Craftable, FIntPoint(8, 4));
 }
 
 void UInv_InventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ThisClass, InventoryList);
+	// 属性本身不加条件，哪些连接能收到由组件的复制条件决定，见 ApplyReplicationPolicy
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, InventoryList, Params);
 }
 
 void UInv_InventoryComponent::TryAddItem(UInv_ItemComponent* ItemComponent)
 {
-	FInv_SlotAvailabilityResult Result = InventoryMenu->HasRoomForItem(ItemComponent);
+	TryAddItems({ItemComponent});
+}
+
+void UInv_InventoryComponent::TryAddItems(const TArray<UInv_ItemComponent*>& ItemComponents)
+{
+	// 只有本地玩家有道具栏 Widget，才能做预测；否则直接交给服务器
+	const bool bCanPredict = IsValid(InventoryMenu);
+
+	// 在网格的副本上一次性规划所有道具的位置
+	TArray<FInv_SlotAvailabilityResult> Results;
+	if (bCanPredict)
+	{
+		Results = InventoryMenu->HasRoomForItems(ItemComponents);
+	}
+
+	TArray<FInv_ItemAddRequest> Requests;
+	Requests.Reserve(ItemComponents.Num());
+	bool bAnyWithoutRoom = false;
+	for (int32 i = 0; i < ItemComponents.Num(); ++i)
+	{
+		if (!IsValid(ItemComponents[i])) continue;
+
+		FInv_ItemAddRequest Request;
+		Request.ItemComponent = ItemComponents[i];
+		Request.PredictionKey = ++NextPredictionKey;
+
+		if (bCanPredict && !PredictAddItem(Request.PredictionKey, ItemComponents[i], Results[i]))
+		{
+			bAnyWithoutRoom = true;
+			continue;
+		}
+		Requests.Add(Request);
+	}
+
+	if (bAnyWithoutRoom)
+	{
+		NoRoomInInventory.Broadcast();
+	}
+
+	if (!Requests.IsEmpty())
+	{
+		Server_AddItems(Requests);
+	}
+}
+
+bool UInv_InventoryComponent::PredictAddItem(const int32 PredictionKey, UInv_ItemComponent* ItemComponent,
+                                             FInv_SlotAvailabilityResult& Result)
+{
+	// 寻找背包里有没有相同类型的道具，将决定是堆叠还是添加新道具
+	Result.ItemId = InventoryList.FindFirstItemByType(ItemComponent->GetItemManifest().GetItemType());
+
+	if (Result.TotalRoomToFill == 0) return false;
+
+	// 为已经存在于道具栏中的道具添加叠加数量，UI 立即更新，等服务器确认
+	// 新道具则等 FastArray 复制过来再显示
+	if (Result.ItemId.IsValid() && Result.bStackable)
+	{
+		OnStackChange.Broadcast(Result);
+		PendingStackPredictions.Add(PredictionKey, Result);
+	}
+	return true;
+}
+
+void UInv_InventoryComponent::Server_AddItems_Implementation(const TArray<FInv_ItemAddRequest>& Requests)
+{
+	// 按顺序处理，后面的请求能看到前面的请求在服务器网格模型中认领的格子。
+	// 同一批次里先加入的新道具不会被后面的同类道具堆叠：客户端规划时它们还没有 ID，只能当作新道具预测。
+	// 所有改动都发生在同一帧，合并为一次 FastArray Delta。
+	TArray<FInv_ItemAddAck> Acks;
+	Acks.Reserve(Requests.Num());
+	TArray<FInv_ItemId> BatchNewItemIds;
+	for (const FInv_ItemAddRequest& Request : Requests)
+	{
+		Acks.Add(AddItem_Authority(Request, BatchNewItemIds));
+	}
+
+	Client_AddItemsAck(Acks);
+}
+
+FInv_ItemAddAck UInv_InventoryComponent::AddItem_Authority(const FInv_ItemAddRequest& Request,
+                                                           TArray<FInv_ItemId>& BatchNewItemIds)
+{
+	FInv_ItemAddAck Ack;
+	Ack.PredictionKey = Request.PredictionKey;
+
+	UInv_ItemComponent* ItemComponent = Request.ItemComponent;
+	if (!IsValid(ItemComponent)) return Ack;
+
+	const FInv_ItemManifest& Manifest = ItemComponent->GetItemManifest();
+	FInv_SpatialGridModel* Model = ServerGridModels.Find(Manifest.GetItemCategory());
+	if (!Model)
+	{
+		UE_LOG(LogInventory, Error, TEXT("ItemComponent doesn't have a valid Item Category."))
+		return Ack;
+	}
+
+	FInv_SlotAvailabilityResult& Result = Ack.Result;
+	Result = Model->FindRoomForItem(Manifest, BatchNewItemIds);
+	if (Result.TotalRoomToFill == 0) return Ack;
+
+	Ack.bAccepted = true;
 
 	// 寻找背包里有没有相同类型的道具，将决定是堆叠还是添加新道具
-	UInv_InventoryItem* FoundItem = InventoryList.FindFirstItemByType(ItemComponent->GetItemManifest().GetItemType());
-	Result.Item = FoundItem;
+	const FInv_ItemId FoundItemId = InventoryList.FindFirstItemByType(Manifest.GetItemType(), BatchNewItemIds);
+	if (FoundItemId.IsValid() && Result.bStackable)
+	{
+		Result.ItemId = FoundItemId;
+		Model->ReserveRoom(Result, Manifest, FoundItemId);
+		WriteBackPlacements(FoundItemId, Manifest.GetItemCategory());
+		AddStacksToItem(ItemComponent, FoundItemId, Result.TotalRoomToFill, Result.Remainder);
+	}
+	else
+	{
+		const FInv_ItemId NewItemId = InventoryList.AddEntry(ItemComponent, ItemStorageMode);
+		BatchNewItemIds.Add(NewItemId);
+		InventoryList.SetTotalStackCount(NewItemId, Result.bStackable ? Result.TotalRoomToFill : 0);
+		Model->ReserveRoom(Result, Manifest, NewItemId);
+		WriteBackPlacements(NewItemId, Manifest.GetItemCategory());
+		OnNewItemAdded(ItemComponent, NewItemId);
+	}
+	return Ack;
+}
+
+void UInv_InventoryComponent::Client_AddItemsAck_Implementation(const TArray<FInv_ItemAddAck>& Acks)
+{
+	bool bAnyRejected = false;
+	for (const FInv_ItemAddAck& Ack : Acks)
+	{
+		FInv_SlotAvailabilityResult Predicted;
+		const bool bPredictedStacks = PendingStackPredictions.RemoveAndCopyValue(Ack.PredictionKey, Predicted);
+		const bool bServerStacks = Ack.bAccepted && Ack.Result.ItemId.IsValid() && Ack.Result.bStackable;
 
-	if (Result.TotalRoomToFill == 0)
+		bAnyRejected |= !Ack.bAccepted;
+
+		// 都是新道具：新道具会通过 FastArray 复制过来，不需要处理
+		if (!bPredictedStacks && !bServerStacks) continue;
+
+		// 预测正确
+		if (bPredictedStacks && bServerStacks && IsSamePlacement(Predicted, Ack.Result)) continue;
+
+		// 撤销预测，应用服务器的结果
+		OnStackReconciled.Broadcast(bPredictedStacks ? Predicted : FInv_SlotAvailabilityResult(),
+		                            bServerStacks ? Ack.Result : FInv_SlotAvailabilityResult());
+	}
+
+	if (bAnyRejected)
 	{
 		NoRoomInInventory.Broadcast();
+	}
+}
+
+void UInv_InventoryComponent::Server_SetItemPlacements_Implementation(
+	const TArray<FInv_ItemPlacementUpdate>& Updates)
+{
+	ApplyPlacementUpdates(Updates);
+}
+
+void UInv_InventoryComponent::Server_SplitItemStack_Implementation(const FInv_ItemId& ItemId, const int32 FromIndex,
+                                                                   const int32 Count)
+{
+	const FInv_InventoryEntry* Entry = InventoryList.FindEntry(ItemId);
+	if (!Entry || !Entry->IsStackable()) return;
+
+	const FInv_ItemManifest& Manifest = Entry->GetItemManifest();
+	const FInv_SpatialGridModel* Model = ServerGridModels.Find(Manifest.GetItemCategory());
+	if (!Model) return;
+
+	FInv_ItemPlacementUpdate Update;
+	Update.ItemId = ItemId;
+	Update.Placements = Entry->GetPlacements();
+	FInv_GridPlacement* From = Update.Placements.FindByPredicate([FromIndex](const FInv_GridPlacement& Placement)
+	{
+		return Placement.Index == FromIndex;
+	});
+	if (!From || Count <= 0 || Count >= From->StackCount) return;
+
+	const int32 ToIndex = Model->FindFreeAnchorForItem(Manifest);
+	if (ToIndex == INDEX_NONE) return;
+
+	From->StackCount -= Count;
+	Update.Placements.Add(FInv_GridPlacement{ToIndex, Count});
+	if (ApplyPlacementUpdates({Update}) && ShouldBroadcastLocally())
+	{
+		OnItemChanged.Broadcast(FInv_ItemHandle(this, ItemId), EInv_ItemChangeFlags::Placements);
+	}
+}
+
+void UInv_InventoryComponent::DropItem(const FInv_ItemHandle& Item, const int32 StackCount)
+{
+	if (Item.GetInventory() != this || !Item.IsValid()) return;
+
+	Server_DropItem(Item.GetItemId(), StackCount);
+}
+
+void UInv_InventoryComponent::Server_DropItem_Implementation(const FInv_ItemId& ItemId, const int32 StackCount)
+{
+	const FInv_InventoryEntry* Entry = InventoryList.FindEntry(ItemId);
+	if (!Entry) return;
+
+	// 只有道具真的出现在世界里之后才从背包中移除，生成失败时道具留在原处
+	const bool bDropAll = !Entry->IsStackable() || StackCount <= 0 || StackCount >= Entry->GetTotalStackCount();
+	if (!SpawnDroppedItem(*Entry, bDropAll ? Entry->GetTotalStackCount() : StackCount)) return;
+
+	if (!bDropAll)
+	{
+		RemoveStacksFromItem(*Entry, StackCount);
+		if (ShouldBroadcastLocally())
+		{
+			OnItemChanged.Broadcast(FInv_ItemHandle(this, ItemId),
+			                        EInv_ItemChangeFlags::StackCount | EInv_ItemChangeFlags::Placements);
+		}
 		return;
 	}
 
-	// 添加道具到道具栏中
-	if (Result.Item.IsValid() && Result.bStackable)
+	// 条目移除之前广播，UI 仍然可以通过句柄读取道具的数据
+	if (ShouldBroadcastLocally())
 	{
-		// 为已经存在于道具栏中的单格道具添加叠加数量
-		OnStackChange.Broadcast(Result);
-		// 请求服务器添加堆叠
-		Server_AddStacksToItem(ItemComponent, Result.TotalRoomToFill, Result.Remainder);
+		OnItemRemoved.Broadcast(FInv_ItemHandle(this, ItemId));
+	}
+	InventoryList.RemoveEntry(ItemId);
+}
+
+void UInv_InventoryComponent::RemoveStacksFromItem(const FInv_InventoryEntry& Entry, int32 StackCount)
+{
+	const FInv_ItemId ItemId = Entry.GetItemId();
+	const FInv_ItemManifest& Manifest = Entry.GetItemManifest();
+	FInv_SpatialGridModel* Model = ServerGridModels.Find(Manifest.GetItemCategory());
+	if (!Model) return;
+
+	const int32 NewTotalStackCount = Entry.GetTotalStackCount() - StackCount;
+
+	// 先拿走零散的堆叠，尽量保留满的格子
+	TArray<FInv_GridPlacement> Placements = Entry.GetPlacements();
+	Placements.StableSort([](const FInv_GridPlacement& A, const FInv_GridPlacement& B)
+	{
+		return A.StackCount < B.StackCount;
+	});
+
+	Model->ClearPlacements(ItemId, Manifest);
+	for (FInv_GridPlacement& Placement : Placements)
+	{
+		const int32 Removed = FMath::Min(StackCount, Placement.StackCount);
+		Placement.StackCount -= Removed;
+		StackCount -= Removed;
+		if (Placement.StackCount > 0)
+		{
+			Model->TryPlaceItem(ItemId, Manifest, Placement);
+		}
+	}
+
+	WriteBackPlacements(ItemId, Manifest.GetItemCategory());
+	InventoryList.SetTotalStackCount(ItemId, NewTotalStackCount);
+}
+
+bool UInv_InventoryComponent::SpawnDroppedItem(const FInv_InventoryEntry& Entry, const int32 StackCount)
+{
+	if (!DropActorClass)
+	{
+		UE_LOG(LogInventory, Warning, TEXT("%s has no DropActorClass, can't drop items."), *GetNameSafe(GetOwner()))
+		return false;
+	}
+
+	const APawn* Pawn = OwningController.IsValid() ? OwningController->GetPawn() : nullptr;
+	if (!IsValid(Pawn)) return false;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	const FVector SpawnLocation = Pawn->GetActorLocation() + Pawn->GetActorForwardVector() * DropSpawnDistance;
+	AActor* DroppedActor = GetWorld()->SpawnActor<AActor>(DropActorClass, SpawnLocation, Pawn->GetActorRotation(),
+	                                                      SpawnParameters);
+	if (!IsValid(DroppedActor))
+	{
+		UE_LOG(LogInventory, Warning, TEXT("Failed to spawn %s for a dropped item."), *GetNameSafe(DropActorClass))
+		return false;
+	}
+
+	UInv_ItemComponent* ItemComponent = DroppedActor->FindComponentByClass<UInv_ItemComponent>();
+	if (!ItemComponent)
+	{
+		UE_LOG(LogInventory, Error, TEXT("DropActorClass %s doesn't have an Item Component."), *GetNameSafe(DropActorClass))
+		DroppedActor->Destroy();
+		return false;
 	}
-	else if (Result.TotalRoomToFill > 0)
+	ItemComponent->InitializeDroppedItem(Entry.GetSharedItemDefinition(), Entry.GetItemManifest(), StackCount);
+	return true;
+}
+
+bool UInv_InventoryComponent::ShouldBroadcastLocally() const
+{
+	const ENetMode NetMode = GetOwner()->GetNetMode();
+	return NetMode == NM_ListenServer || NetMode == NM_Standalone;
+}
+
+bool UInv_InventoryComponent::ApplyPlacementUpdates(const TArray<FInv_ItemPlacementUpdate>& Updates)
+{
+	// 在服务器网格模型的副本上验证，全部合法才提交，交换两个道具这类操作就不会只生效一半
+	TMap<EInv_ItemCategory, FInv_SpatialGridModel> ScratchModels;
+	auto GetScratchModel = [this, &ScratchModels](const EInv_ItemCategory Category) -> FInv_SpatialGridModel*
+	{
+		if (FInv_SpatialGridModel* Model = ScratchModels.Find(Category)) return Model;
+		const FInv_SpatialGridModel* ServerModel = ServerGridModels.Find(Category);
+		return ServerModel ? &ScratchModels.Add(Category, *ServerModel) : nullptr;
+	};
+
+	bool bValid = true;
+	TSet<FInv_ItemId> SeenItemIds;
+	for (const FInv_ItemPlacementUpdate& Update : Updates)
+	{
+		bool bAlreadySeen = false;
+		SeenItemIds.Add(Update.ItemId, &bAlreadySeen);
+
+		const FInv_InventoryEntry* Entry = InventoryList.FindEntry(Update.ItemId);
+		FInv_SpatialGridModel* Model = Entry && !bAlreadySeen && IsValidPlacementCount(*Entry, Update.Placements)
+			                               ? GetScratchModel(Entry->GetItemManifest().GetItemCategory())
+			                               : nullptr;
+		if (!Model)
+		{
+			bValid = false;
+			break;
+		}
+		Model->ClearPlacements(Update.ItemId, Entry->GetItemManifest());
+	}
+
+	for (int32 i = 0; bValid && i < Updates.Num(); ++i)
+	{
+		const FInv_ItemPlacementUpdate& Update = Updates[i];
+		const FInv_ItemManifest& Manifest = InventoryList.FindEntry(Update.ItemId)->GetItemManifest();
+		FInv_SpatialGridModel* Model = GetScratchModel(Manifest.GetItemCategory());
+		for (const FInv_GridPlacement& Placement : Update.Placements)
+		{
+			if (!Model->TryPlaceItem(Update.ItemId, Manifest, Placement))
+			{
+				bValid = false;
+				break;
+			}
+		}
+	}
+
+	if (!bValid)
+	{
+		UE_LOG(LogInventory, Warning, TEXT("Rejected invalid item placement update from %s."), *GetNameSafe(GetOwner()))
+		for (const FInv_ItemPlacementUpdate& Update : Updates)
+		{
+			InventoryList.MarkItemEntryDirty(Update.ItemId);
+		}
+		return false;
+	}
+
+	for (auto& [Category, Model] : ScratchModels)
+	{
+		ServerGridModels.Add(Category, MoveTemp(Model));
+	}
+	for (const FInv_ItemPlacementUpdate& Update : Updates)
+	{
+		WriteBackPlacements(Update.ItemId, InventoryList.FindEntry(Update.ItemId)->GetItemManifest().GetItemCategory());
+	}
+	return true;
+}
+
+bool UInv_InventoryComponent::IsValidPlacementCount(const FInv_InventoryEntry& Entry,
+                                                    const TArray<FInv_GridPlacement>& Placements)
+{
+	// 不可堆叠的道具只能有一个锚点；可堆叠道具各个锚点上的数量加起来不能超过道具的总数
+	if (!Entry.IsStackable()) return Placements.Num() <= 1;
+
+	int64 StackSum = 0;
+	for (const FInv_GridPlacement& Placement : Placements)
 	{
-		// 道具栏里并不存在该类道具，找一个空格子创建一个新的道具
-		// 请求服务器添加道具
-		Server_AddNewItem(ItemComponent, Result.bStackable ? Result.TotalRoomToFill : 0);
+		StackSum += Placement.StackCount;
 	}
+	return StackSum <= Entry.GetTotalStackCount();
 }
 
-void UInv_InventoryComponent::Server_AddNewItem_Implementation(UInv_ItemComponent* ItemComponent, int32 StackCount)
+void UInv_InventoryComponent::WriteBackPlacements(const FInv_ItemId ItemId, const EInv_ItemCategory Category)
 {
-	UInv_InventoryItem* NewItem = InventoryList.AddEntry(ItemComponent);
+	const FInv_SpatialGridModel* Model = ServerGridModels.Find(Category);
+	if (!Model) return;
 
+	TArray<FInv_GridPlacement> Placements;
+	Model->GetPlacements(ItemId, Placements);
+	InventoryList.SetPlacements(ItemId, Category, Placements);
+}
+
+const TArray<FInv_GridPlacement>* UInv_InventoryComponent::FindItemPlacements(const FInv_ItemId ItemId) const
+{
+	return InventoryList.FindPlacements(ItemId);
+}
+
+bool UInv_InventoryComponent::IsSamePlacement(const FInv_SlotAvailabilityResult& A, const FInv_SlotAvailabilityResult& B)
+{
+	if (A.TotalRoomToFill != B.TotalRoomToFill || A.Remainder != B.Remainder) return false;
+	if (A.SlotAvailabilities.Num() != B.SlotAvailabilities.Num()) return false;
+
+	for (int32 i = 0; i < A.SlotAvailabilities.Num(); ++i)
+	{
+		const FInv_SlotAvailability& SlotA = A.SlotAvailabilities[i];
+		const FInv_SlotAvailability& SlotB = B.SlotAvailabilities[i];
+		if (SlotA.Index != SlotB.Index || SlotA.AmountToFill != SlotB.AmountToFill ||
+			SlotA.bItemAtIndex != SlotB.bItemAtIndex)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void UInv_InventoryComponent::OnNewItemAdded(UInv_ItemComponent* ItemComponent, const FInv_ItemId NewItemId)
+{
 	// 对于独立游戏（Standalone）或本地服务器（Listen Server），物品不会被复制到客户端，因此需要主动调用OnItemAdded委托。
 	// Listen Server：本地玩家既是“发起者”（服务器）也会“接收”数据，但 Unreal 的复制系统默认不会把服务器自己当作“客户端”再发一次给自己，所以那条复制管线根本不会走。
 	// Standalone：根本没有网络层，复制管线压根不启动。
-	if (GetOwner()->GetNetMode() == NM_ListenServer || GetOwner()->GetNetMode() == NM_Standalone)
+	if (ShouldBroadcastLocally())
 	{
-		OnItemAdded.Broadcast(NewItem);
+		OnItemAdded.Broadcast(FInv_ItemHandle(this, NewItemId));
 	}
 
 	// 通知 Item Component 销毁自己的 Owner Actor
 	ItemComponent->PickedUp();
 }
 
-void UInv_InventoryComponent::Server_AddStacksToItem_Implementation(UInv_ItemComponent* ItemComponent, int32 StackCount,
-                                                                    int32 Remainder)
+void UInv_InventoryComponent::AddStacksToItem(UInv_ItemComponent* ItemComponent, const FInv_ItemId ItemId,
+                                              int32 StackCount, int32 Remainder)
 {
-	const FGameplayTag& ItemType = IsValid(ItemComponent)
-		                               ? ItemComponent->GetItemManifest().GetItemType()
-		                               : FGameplayTag::EmptyTag;
-	UInv_InventoryItem* Item = InventoryList.FindFirstItemByType(ItemType);
-	if (!IsValid(Item)) return;
-
-	Item->SetTotalStackCount(Item->GetTotalStackCount() + StackCount);
+	const FInv_InventoryEntry* Entry = InventoryList.FindEntry(ItemId);
+	if (!Entry) return;
+	InventoryList.SetTotalStackCount(ItemId, Entry->GetTotalStackCount() + StackCount);
 
 	// 如果全捡光了，就通知 Item Component 销毁自己的 Owner Actor
 	// 不然就修改场景中道具的剩余数量——这里要解决的问题是，必须修改 Fragment，所以必须要拿到一个 Mutable Fragment
@@ -98,13 +481,19 @@ void UInv_InventoryComponent::Server_AddStacksToItem_Implementation(UInv_ItemCom
 	{
 		ItemComponent->PickedUp();
 	}
-	else if (FInv_StackableFragment* StackableFragment = ItemComponent->GetItemManifest().GetMutableFragmentOfType<
-		FInv_StackableFragment>())
+	else if (FInv_StackableFragment* StackableFragment = ItemComponent->GetMutableItemManifest().
+		GetMutableFragmentOfType<FInv_StackableFragment>())
 	{
 		StackableFragment->SetStackCount(Remainder);
 	}
 }
 
+FIntPoint UInv_InventoryComponent::GetGridSize(const EInv_ItemCategory Category) const
+{
+	const FIntPoint* GridSize = GridSizes.Find(Category);
+	return GridSize ? *GridSize : FIntPoint::ZeroValue;
+}
+
 void UInv_InventoryComponent::ToggleInventoryMenu()
 {
 	if (bInventoryMenuOpen)
@@ -124,9 +513,102 @@ void UInv_InventoryComponent::AddRepSubObj(UObject* SubObj)
 
 	// IsReadyForReplication()：组件是否已初始化并加入复制网络系统，准备开始复制。
 
+	// 道具子对象使用与组件相同的复制条件，否则其他连接虽然收不到道具栏，却仍会收到道具
 	if (IsUsingRegisteredSubObjectList() && IsReadyForReplication() && IsValid(SubObj))
 	{
-		AddReplicatedSubObject(SubObj);
+		AddReplicatedSubObject(SubObj, GetReplicationCondition());
+		RegisterInObserverGroup(SubObj);
+	}
+}
+
+void UInv_InventoryComponent::RemoveRepSubObj(UObject* SubObj)
+{
+	if (IsUsingRegisteredSubObjectList() && IsValid(SubObj))
+	{
+		UnregisterFromObserverGroup(SubObj);
+		RemoveReplicatedSubObject(SubObj);
+	}
+}
+
+void UInv_InventoryComponent::ClearServerPlacements(const FInv_InventoryEntry& Entry)
+{
+	const FInv_ItemManifest& Manifest = Entry.GetItemManifest();
+	if (FInv_SpatialGridModel* Model = ServerGridModels.Find(Manifest.GetItemCategory()))
+	{
+		Model->ClearPlacements(Entry.GetItemId(), Manifest);
+	}
+}
+
+void UInv_InventoryComponent::AddInventoryObserver(APlayerController* Observer)
+{
+	if (ObserverNetGroup.IsNone() || !IsValid(Observer)) return;
+
+	Observer->IncludeInNetConditionGroup(ObserverNetGroup);
+}
+
+void UInv_InventoryComponent::RemoveInventoryObserver(APlayerController* Observer)
+{
+	if (ObserverNetGroup.IsNone() || !IsValid(Observer) || Observer == OwningController) return;
+
+	Observer->RemoveFromNetConditionGroup(ObserverNetGroup);
+}
+
+ELifetimeCondition UInv_InventoryComponent::GetReplicationCondition() const
+{
+	return ReplicationPolicy == EInv_InventoryReplicationPolicy::OwnerAndObservers ? COND_NetGroup : COND_OwnerOnly;
+}
+
+void UInv_InventoryComponent::ApplyReplicationPolicy()
+{
+	AActor* Owner = GetOwner();
+
+	// Actor 只与拥有者相关时（比如 PlayerController），订阅者永远收不到组件，退回 OwnerOnly
+	if (ReplicationPolicy == EInv_InventoryReplicationPolicy::OwnerAndObservers &&
+		!ensureMsgf(!Owner->bOnlyRelevantToOwner,
+		            TEXT("%s uses OwnerAndObservers but %s is only relevant to its owner, observers will never receive the inventory. Falling back to OwnerOnly."),
+		            *GetPathNameSafe(this), *GetNameSafe(Owner)))
+	{
+		ReplicationPolicy = EInv_InventoryReplicationPolicy::OwnerOnly;
+	}
+
+	if (ReplicationPolicy == EInv_InventoryReplicationPolicy::OwnerAndObservers)
+	{
+		ObserverNetGroup = FName(TEXT("InventoryObservers"), GetUniqueID());
+		RegisterInObserverGroup(this);
+
+		// 拥有者总能看到自己的道具栏
+		AddInventoryObserver(OwningController.Get());
+	}
+
+	// 只有使用显式注册子对象列表的 Actor 才支持按组件设置复制条件
+	if (!Owner->IsUsingRegisteredSubObjectList())
+	{
+		// 只与拥有者相关的 Actor 不设置条件也只会复制给拥有者，其他情况下组件会复制给所有相关连接
+		UE_CLOG(!Owner->bOnlyRelevantToOwner, LogInventory, Error,
+		        TEXT("%s doesn't use the registered subobject list, the replication condition of %s can't be applied and it replicates to every relevant connection."),
+		        *GetNameSafe(Owner), *GetPathNameSafe(this));
+		return;
+	}
+	Owner->SetReplicatedComponentNetCondition(this, GetReplicationCondition());
+}
+
+void UInv_InventoryComponent::RegisterInObserverGroup(UObject* SubObj) const
+{
+	if (ObserverNetGroup.IsNone()) return;
+
+	if (UNetworkSubsystem* NetworkSubsystem = GetWorld()->GetSubsystem<UNetworkSubsystem>())
+	{
+		NetworkSubsystem->GetNetConditionGroupManager().RegisterSubObjectInGroup(SubObj, ObserverNetGroup);
+	}
+}
+
+void UInv_InventoryComponent::UnregisterFromObserverGroup(UObject* SubObj) const
+{
+	if (ObserverNetGroup.IsNone()) return;
+
+	if (UNetworkSubsystem* NetworkSubsystem = GetWorld()->GetSubsystem<UNetworkSubsystem>())
+	{
+		NetworkSubsystem->GetNetConditionGroupManager().UnregisterSubObjectFromGroup(SubObj, ObserverNetGroup);
 	}
 }
 
@@ -137,10 +619,47 @@ void UInv_InventoryComponent::BeginPlay()
 	ConstructInventory();
 }
 
+void UInv_InventoryComponent::ConstructServerGridModels()
+{
+	ServerGridModels.Reset();
+	for (const auto& [Category, GridSize] : GridSizes)
+	{
+		if (!FInv_SpatialGridModel::IsValidSize(GridSize.Y, GridSize.X))
+		{
+			UE_LOG(LogInventory, Error, TEXT("%s has an invalid grid size %dx%d for category %s, the grid is disabled."),
+			       *GetPathNameSafe(this), GridSize.X, GridSize.Y, *UEnum::GetValueAsString(Category));
+			continue;
+		}
+		ServerGridModels.Add(Category).Initialize(GridSize.Y, GridSize.X);
+	}
+}
+
+#if WITH_EDITOR
+void UInv_InventoryComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (PropertyChangedEvent.GetMemberPropertyName() != GET_MEMBER_NAME_CHECKED(ThisClass, GridSizes)) return;
+
+	// 在配置时就把尺寸限制在网格模型支持的范围内
+	for (auto& [Category, GridSize] : GridSizes)
+	{
+		GridSize.X = FMath::Clamp(GridSize.X, 1, FInv_SpatialGridModel::MaxColumns);
+		GridSize.Y = FMath::Max(GridSize.Y, 1);
+	}
+}
+#endif
+
 void UInv_InventoryComponent::ConstructInventory()
 {
 	OwningController = Cast<APlayerController>(GetOwner());
 	checkf(OwningController.IsValid(), TEXT("Inventory Component should have a Player Controller as Owner."))
+
+	if (GetOwner()->HasAuthority())
+	{
+		ConstructServerGridModels();
+		ApplyReplicationPolicy();
+	}
 	if (!OwningController->IsLocalController()) return;
 
 	InventoryMenu = CreateWidget<UInv_InventoryBase>(OwningController.Get(), InventoryMenuClass);
@@ -3,15 +3,35 @@
 #include "InventoryManagement/Components/Inv_InventoryComponent.h"
 #include "Items/Inv_InventoryItem.h"
 #include "Items/Components/Inv_ItemComponent.h"
+#include "Items/Definition/Inv_ItemDefinition.h"
+#include "Net/Core/PushModel/PushModel.h"
 
-TArray<UInv_InventoryItem*> FInv_InventoryFastArray::GetAllItems() const
+const FInv_ItemManifest& FInv_InventoryEntry::GetItemManifest() const
 {
-	TArray<UInv_InventoryItem*> Results;
+	return Item ? Item->GetItemManifest() : Instance.GetItemManifest();
+}
+
+bool FInv_InventoryEntry::IsStackable() const
+{
+	return Item ? Item->IsStackable() : Instance.IsStackable();
+}
+
+UInv_ItemDefinition* FInv_InventoryEntry::GetSharedItemDefinition() const
+{
+	if (Item) return Item->HasManifestOverride() ? nullptr : Item->GetItemDefinition();
+	return Instance.HasManifestOverride() ? nullptr : Instance.GetItemDefinition();
+}
+
+TArray<FInv_ItemHandle> FInv_InventoryFastArray::GetAllItems() const
+{
+	const UInv_InventoryComponent* IC = Cast<UInv_InventoryComponent>(OwnerComponent);
+
+	TArray<FInv_ItemHandle> Results;
 	Results.Reserve(Entries.Num());
 	for (const auto& Entry : Entries)
 	{
-		if (!IsValid(Entry.Item)) continue;
-		Results.Add(Entry.Item);
+		if (!Entry.ItemId.IsValid()) continue;
+		Results.Emplace(IC, Entry.ItemId);
 	}
 	return Results;
 }
@@ -23,75 +43,313 @@ void FInv_InventoryFastArray::PreReplicatedRemove(const TArrayView<int32> Remove
 
 	for (int32 Index : RemovedIndices)
 	{
-		IC->OnItemRemoved.Broadcast(Entries[Index].Item);
+		RemoveFromTypeIndex(Entries[Index]);
+		// 条目此时还在数列中，UI 仍然可以通过句柄读取道具的数据
+		IC->OnItemRemoved.Broadcast(FInv_ItemHandle(IC, Entries[Index].ItemId));
 	}
+	bEntryIndicesDirty = true;
 }
 
 void FInv_InventoryFastArray::PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize)
 {
 	UInv_InventoryComponent* IC = Cast<UInv_InventoryComponent>(OwnerComponent);
 	if (!IsValid(IC)) return;
+
+	// 先把下标整理好，广播时 UI 才能通过句柄找到新条目
+	RebuildEntryIndices();
 	for (int32 Index : AddedIndices)
 	{
-		IC->OnItemAdded.Broadcast(Entries[Index].Item);
+		FInv_InventoryEntry& Entry = Entries[Index];
+		if (IsValid(Entry.Item))
+		{
+			Entry.Item->SetTotalStackCount(Entry.TotalStackCount);
+		}
+		Entry.Instance.PostReplicatedUpdate();
+		Entry.AppliedTotalStackCount = Entry.TotalStackCount;
+		Entry.AppliedPlacements = Entry.Placements;
+
+		AddToTypeIndex(Entry);
+		IC->OnItemAdded.Broadcast(FInv_ItemHandle(IC, Entry.ItemId));
 	}
 }
 
-UInv_InventoryItem* FInv_InventoryFastArray::AddEntry(UInv_ItemComponent* ItemComponent)
+void FInv_InventoryFastArray::PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize)
 {
-	check(OwnerComponent);
-	AActor* OwningActor = OwnerComponent->GetOwner();
-	check(OwningActor->HasAuthority());
 	UInv_InventoryComponent* IC = Cast<UInv_InventoryComponent>(OwnerComponent);
-	if (!IsValid(IC)) return nullptr;
+	if (!IsValid(IC)) return;
 
-	FInv_InventoryEntry& NewEntry = Entries.AddDefaulted_GetRef();
-	NewEntry.Item = ItemComponent->GetItemManifest().Manifest(OwningActor);
+	bEntryIndicesDirty = true;
+	for (int32 Index : ChangedIndices)
+	{
+		FInv_InventoryEntry& Entry = Entries[Index];
+
+		// 条目中的道具指针或道具定义可能在这次更新中才解析出来
+		if (!Entry.IndexedItemType.IsValid())
+		{
+			AddToTypeIndex(Entry);
+		}
+
+		// 与上一次处理过的状态比较，只通知真正变化的部分
+		EInv_ItemChangeFlags ChangeFlags = EInv_ItemChangeFlags::None;
+		if (IsValid(Entry.Item))
+		{
+			Entry.Item->SetTotalStackCount(Entry.TotalStackCount);
+		}
+		if (Entry.AppliedTotalStackCount != Entry.TotalStackCount)
+		{
+			Entry.AppliedTotalStackCount = Entry.TotalStackCount;
+			ChangeFlags |= EInv_ItemChangeFlags::StackCount;
+		}
+		if (Entry.AppliedPlacements != Entry.Placements)
+		{
+			Entry.AppliedPlacements = Entry.Placements;
+			ChangeFlags |= EInv_ItemChangeFlags::Placements;
+		}
 
-	IC->AddRepSubObj(NewEntry.Item);
-	MarkItemDirty(NewEntry);
+		// 内联的道具数据随条目一起复制，Manifest 副本可能在这次更新中变化
+		if (!Entry.Item && Entry.Instance.HasManifestOverride())
+		{
+			Entry.Instance.PostReplicatedUpdate();
+			ChangeFlags |= EInv_ItemChangeFlags::Fragments;
+		}
 
-	return NewEntry.Item;
+		// 服务器强制重发的条目（拒绝了客户端的布局）也要让 UI 回到服务器的布局
+		IC->OnItemChanged.Broadcast(FInv_ItemHandle(IC, Entry.ItemId), ChangeFlags == EInv_ItemChangeFlags::None
+			                                                             ? EInv_ItemChangeFlags::Placements
+			                                                             : ChangeFlags);
+	}
 }
 
-UInv_InventoryItem* FInv_InventoryFastArray::AddEntry(UInv_InventoryItem* Item)
+FInv_ItemId FInv_InventoryFastArray::AddEntry(UInv_ItemComponent* ItemComponent, const EInv_ItemStorageMode StorageMode)
 {
 	check(OwnerComponent);
 	AActor* OwningActor = OwnerComponent->GetOwner();
 	check(OwningActor->HasAuthority());
+	UInv_InventoryComponent* IC = Cast<UInv_InventoryComponent>(OwnerComponent);
+	if (!IsValid(IC)) return FInv_ItemId();
 
 	// 向数列中添加一个新的 Entry
 	FInv_InventoryEntry& NewEntry = Entries.AddDefaulted_GetRef();
-	// 设置 Entry 中的 Item 指针
-	NewEntry.Item = Item;
+	LastItemId = LastItemId.Next();
+	NewEntry.ItemId = LastItemId;
+
+	// 有道具定义时只引用定义，否则退回到复制一份完整的 Manifest
+	UInv_ItemDefinition* Definition = ItemComponent->GetItemDefinition();
+	if (StorageMode == EInv_ItemStorageMode::Inline)
+	{
+		if (IsValid(Definition))
+		{
+			NewEntry.Instance.SetItemDefinition(Definition);
+		}
+		else
+		{
+			NewEntry.Instance.SetItemManifest(ItemComponent->GetItemManifest());
+		}
+	}
+	else
+	{
+		NewEntry.Item = IsValid(Definition)
+			                ? Definition->Manifest(OwningActor)
+			                : ItemComponent->GetItemManifest().Manifest(OwningActor);
+		NewEntry.Item->SetItemId(NewEntry.ItemId);
+		IC->AddRepSubObj(NewEntry.Item);
+	}
+
+	AddToTypeIndex(NewEntry);
+	EntryIndices.Add(NewEntry.ItemId, Entries.Num() - 1);
 
 	// **重要**：需要手动标记数据 Dirty
-	MarkItemDirty(NewEntry);
-	return Item;
+	MarkEntryDirty(NewEntry);
+	return NewEntry.ItemId;
+}
+
+void FInv_InventoryFastArray::RemoveEntry(const FInv_ItemId ItemId)
+{
+	if (RemoveEntryAtSwap(ItemId))
+	{
+		// **重要**：必须手动标记数据 Dirty，这次是标记数列为 Dirty
+		MarkEntriesDirty();
+	}
+}
+
+void FInv_InventoryFastArray::RemoveEntries(const TArrayView<const FInv_ItemId> ItemIds)
+{
+	bool bRemovedAny = false;
+	for (const FInv_ItemId ItemId : ItemIds)
+	{
+		bRemovedAny |= RemoveEntryAtSwap(ItemId);
+	}
+
+	if (bRemovedAny)
+	{
+		MarkEntriesDirty();
+	}
+}
+
+bool FInv_InventoryFastArray::RemoveEntryAtSwap(const FInv_ItemId ItemId)
+{
+	check(OwnerComponent);
+	check(OwnerComponent->GetOwner()->HasAuthority());
+
+	if (bEntryIndicesDirty)
+	{
+		RebuildEntryIndices();
+	}
+
+	int32 Index = INDEX_NONE;
+	if (!EntryIndices.RemoveAndCopyValue(ItemId, Index)) return false;
+
+	RemoveFromTypeIndex(Entries[Index]);
+	UInv_InventoryItem* Item = Entries[Index].Item;
+
+	// 道具不再属于道具栏，清除它在服务器网格模型中的锚点
+	UInv_InventoryComponent* IC = Cast<UInv_InventoryComponent>(OwnerComponent);
+	if (IC)
+	{
+		IC->ClearServerPlacements(Entries[Index]);
+	}
+
+	// 用最后一个条目填补空位，只需要更新被移动的那个条目的下标
+	Entries.RemoveAtSwap(Index);
+	if (Entries.IsValidIndex(Index))
+	{
+		EntryIndices.Add(Entries[Index].ItemId, Index);
+	}
+
+	// 也不要让复制系统继续考虑它
+	if (IsValid(Item) && IC)
+	{
+		IC->RemoveRepSubObj(Item);
+	}
+	return true;
+}
+
+FInv_ItemId FInv_InventoryFastArray::FindFirstItemByType(const FGameplayTag& ItemType,
+                                                         const TConstArrayView<FInv_ItemId> ExcludedItemIds) const
+{
+	const auto* FoundItems = ItemsByType.Find(ItemType);
+	if (!FoundItems) return FInv_ItemId();
+
+	for (const FInv_ItemId& ItemId : *FoundItems)
+	{
+		if (!ExcludedItemIds.Contains(ItemId)) return ItemId;
+	}
+	return FInv_ItemId();
+}
+
+const TArray<FInv_GridPlacement>* FInv_InventoryFastArray::FindPlacements(const FInv_ItemId ItemId) const
+{
+	const FInv_InventoryEntry* Entry = FindEntry(ItemId);
+	return Entry ? &Entry->Placements : nullptr;
+}
+
+void FInv_InventoryFastArray::SetPlacements(const FInv_ItemId ItemId, const EInv_ItemCategory Category,
+                                            const TArray<FInv_GridPlacement>& Placements)
+{
+	FInv_InventoryEntry* Entry = FindEntry(ItemId);
+	if (!Entry) return;
+	if (Entry->GridCategory == Category && Entry->Placements == Placements) return;
+
+	Entry->GridCategory = Category;
+	Entry->Placements = Placements;
+	MarkEntryDirty(*Entry);
+}
+
+void FInv_InventoryFastArray::SetTotalStackCount(const FInv_ItemId ItemId, const int32 Count)
+{
+	FInv_InventoryEntry* Entry = FindEntry(ItemId);
+	if (!Entry) return;
+
+	if (IsValid(Entry->Item))
+	{
+		Entry->Item->SetTotalStackCount(Count);
+	}
+	if (Entry->TotalStackCount == Count) return;
+
+	Entry->TotalStackCount = Count;
+	MarkEntryDirty(*Entry);
 }
 
-void FInv_InventoryFastArray::RemoveEntry(UInv_InventoryItem* Item)
+void FInv_InventoryFastArray::MarkItemEntryDirty(const FInv_ItemId ItemId)
 {
-	// 遍历数列
-	for (auto EntryIt = Entries.CreateIterator(); EntryIt; ++EntryIt)
+	if (FInv_InventoryEntry* Entry = FindEntry(ItemId))
 	{
-		FInv_InventoryEntry& Entry = *EntryIt;
-		// 找到匹配元素
-		if (Entry.Item == Item)
+		MarkEntryDirty(*Entry);
+	}
+}
+
+void FInv_InventoryFastArray::MarkEntryDirty(FInv_InventoryEntry& Entry)
+{
+	MarkItemDirty(Entry);
+	MarkOwnerPropertyDirty();
+}
+
+void FInv_InventoryFastArray::MarkEntriesDirty()
+{
+	MarkArrayDirty();
+	MarkOwnerPropertyDirty();
+}
+
+void FInv_InventoryFastArray::MarkOwnerPropertyDirty() const
+{
+	if (UInv_InventoryComponent* IC = Cast<UInv_InventoryComponent>(OwnerComponent))
+	{
+		MARK_PROPERTY_DIRTY_FROM_NAME(UInv_InventoryComponent, InventoryList, IC);
+	}
+}
+
+FInv_InventoryEntry* FInv_InventoryFastArray::FindEntry(const FInv_ItemId ItemId)
+{
+	return const_cast<FInv_InventoryEntry*>(std::as_const(*this).FindEntry(ItemId));
+}
+
+const FInv_InventoryEntry* FInv_InventoryFastArray::FindEntry(const FInv_ItemId ItemId) const
+{
+	if (bEntryIndicesDirty)
+	{
+		RebuildEntryIndices();
+	}
+
+	const int32* Index = EntryIndices.Find(ItemId);
+	return Index ? &Entries[*Index] : nullptr;
+}
+
+void FInv_InventoryFastArray::RebuildEntryIndices() const
+{
+	EntryIndices.Reset();
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		if (Entries[Index].ItemId.IsValid())
 		{
-			// 移除元素
-			EntryIt.RemoveCurrent();
-			// **重要**：必须手动标记数据 Dirty，这次是标记数列为 Dirty
-			MarkArrayDirty();
+			EntryIndices.Add(Entries[Index].ItemId, Index);
 		}
 	}
+	bEntryIndicesDirty = false;
+}
+
+void FInv_InventoryFastArray::AddToTypeIndex(FInv_InventoryEntry& Entry)
+{
+	// 客户端上道具定义或子对象还没有解析时拿不到类型，等 PostReplicatedChange 再登记
+	const FGameplayTag ItemType = Entry.GetItemManifest().GetItemType();
+	if (!ItemType.IsValid()) return;
+
+	ItemsByType.FindOrAdd(ItemType).Add(Entry.ItemId);
+	Entry.IndexedItemType = ItemType;
 }
 
-UInv_InventoryItem* FInv_InventoryFastArray::FindFirstItemByType(const FGameplayTag& ItemType)
+void FInv_InventoryFastArray::RemoveFromTypeIndex(FInv_InventoryEntry& Entry)
 {
-	auto* FoundItem = Entries.FindByPredicate([ItemType = ItemType](const FInv_InventoryEntry& Entry)
+	const FGameplayTag ItemType = Entry.IndexedItemType;
+	if (!ItemType.IsValid()) return;
+
+	Entry.IndexedItemType = FGameplayTag();
+	auto* FoundItems = ItemsByType.Find(ItemType);
+	if (!FoundItems) return;
+
+	// 保持顺序，保证 FindFirstItemByType 总是返回最早加入的道具
+	FoundItems->RemoveSingle(Entry.ItemId);
+	if (FoundItems->IsEmpty())
 	{
-		return Entry.Item->GetItemManifest().GetItemType().MatchesTagExact(ItemType);
-	});
-	return FoundItem ? FoundItem->Item : nullptr;
+		ItemsByType.Remove(ItemType);
+	}
 }
@@ -0,0 +1,441 @@
+#include "InventoryManagement/Spatial/Inv_SpatialGridModel.h"
+
+#include "Items/Fragments/Inv_ItemFragment.h"
+#include "Items/Manifest/Inv_ItemManifest.h"
+
+namespace
+{
+	FIntPoint GetItemDimensions(const FInv_ItemManifest& Manifest)
+	{
+		const FInv_GridFragment* GridFragment = Manifest.GetFragmentOfType<FInv_GridFragment>();
+		return GridFragment ? GridFragment->GetGridSize() : FIntPoint(1, 1);
+	}
+
+	/**
+	 * 纵向按位与：OutAnchors[Y] = Fit[Y] & Fit[Y + 1] & ... & Fit[Y + Height - 1]
+	 * 每次用一个 128 位向量寄存器同时处理两行。
+	 */
+	void AndRowsVertically(uint64* OutAnchors, const uint64* Fit, const int32 NumAnchorRows, const int32 Height)
+	{
+		FMemory::Memcpy(OutAnchors, Fit, NumAnchorRows * sizeof(uint64));
+
+		for (int32 Offset = 1; Offset < Height; ++Offset)
+		{
+			const uint64* Source = Fit + Offset;
+			int32 Row = 0;
+			for (; Row + 2 <= NumAnchorRows; Row += 2)
+			{
+				const VectorRegister4Int Anchors = VectorIntLoad(OutAnchors + Row);
+				const VectorRegister4Int Rows = VectorIntLoad(Source + Row);
+				VectorIntStore(VectorIntAnd(Anchors, Rows), OutAnchors + Row);
+			}
+			for (; Row < NumAnchorRows; ++Row)
+			{
+				OutAnchors[Row] &= Source[Row];
+			}
+		}
+	}
+
+	/**
+	 * 横向：返回值的第 X 位表示 (X, Y) 开始的 Width 个格子都空闲。
+	 * 用倍增的方式移位相与，Width 再大也只需要 log2(Width) 次运算；
+	 * 超出列数的位在 Free 中都是 0，所以越过右边界的锚点会被自动排除。
+	 */
+	uint64 GetRowFit(const uint64 BlockedRow, const uint64 ColumnMask, const int32 Width)
+	{
+		uint64 RowFit = ~BlockedRow & ColumnMask;
+		for (int32 Covered = 1; Covered < Width;)
+		{
+			const int32 Shift = FMath::Min(Covered, Width - Covered);
+			RowFit &= RowFit >> Shift;
+			Covered += Shift;
+		}
+		return RowFit;
+	}
+
+	/** 在 StartIndex 之后（包含）找第一个被置位的锚点 */
+	int32 FindFirstSetAnchor(const TConstArrayView<uint64> Anchors, const int32 Columns, const int32 StartIndex)
+	{
+		const int32 StartRow = FMath::Max(StartIndex, 0) / Columns;
+		const int32 StartColumn = FMath::Max(StartIndex, 0) % Columns;
+		for (int32 Y = StartRow; Y < Anchors.Num(); ++Y)
+		{
+			const uint64 RowAnchors = Y == StartRow ? Anchors[Y] & (~0ull << StartColumn) : Anchors[Y];
+			if (RowAnchors != 0)
+			{
+				return Y * Columns + static_cast<int32>(FMath::CountTrailingZeros64(RowAnchors));
+			}
+		}
+		return INDEX_NONE;
+	}
+}
+
+void FInv_SpatialGridModel::Initialize(const int32 InRows, const int32 InColumns)
+{
+	const bool bValidSize = ensureMsgf(IsValidSize(InRows, InColumns),
+	                                   TEXT("Invalid inventory grid size %dx%d, grids need 1 to %d columns."),
+	                                   InColumns, InRows, MaxColumns);
+
+	// 不合法时不做截断，截断后的网格会和另一端的网格不一致
+	Rows = bValidSize ? InRows : 0;
+	Columns = bValidSize ? InColumns : 0;
+	ColumnMask = GetWidthMask(Columns);
+
+	const int32 NumCells = Num();
+	RowMasks.Init(0, Rows);
+	AnchorMasks.Init(0, Rows);
+	UpperLeftIndices.Init(INDEX_NONE, NumCells);
+	StackCounts.Init(0, NumCells);
+	ItemTypes.Init(FGameplayTag::EmptyTag, NumCells);
+	ItemIds.Init(FInv_ItemId(), NumCells);
+}
+
+uint64 FInv_SpatialGridModel::GetWidthMask(const int32 Width)
+{
+	if (Width <= 0) return 0;
+	return Width >= 64 ? ~0ull : (1ull << Width) - 1;
+}
+
+FInv_ItemId FInv_SpatialGridModel::GetItemId(const int32 Index) const
+{
+	if (!IsValidIndex(Index)) return FInv_ItemId();
+
+	const int32 UpperLeftIndex = UpperLeftIndices[Index];
+	return UpperLeftIndex != INDEX_NONE ? ItemIds[UpperLeftIndex] : FInv_ItemId();
+}
+
+bool FInv_SpatialGridModel::IsInGridBounds(const int32 StartIndex, const FIntPoint& Dimensions) const
+{
+	if (!IsValidIndex(StartIndex)) return false;
+
+	const int32 EndColumn = (StartIndex % Columns) + Dimensions.X;
+	const int32 EndRow = (StartIndex / Columns) + Dimensions.Y;
+	return EndColumn <= Columns && EndRow <= Rows;
+}
+
+void FInv_SpatialGridModel::PlaceItem(const FInv_ItemId ItemId, const FGameplayTag& ItemType, const int32 UpperLeftIndex,
+                                      const FIntPoint& Dimensions, const int32 StackCount)
+{
+	PlaceAnchor(UpperLeftIndex, Dimensions, StackCount, ItemType, ItemId);
+}
+
+void FInv_SpatialGridModel::ReserveRoom(const FInv_SlotAvailabilityResult& Result, const FInv_ItemManifest& Manifest,
+                                        const FInv_ItemId ItemId)
+{
+	const FIntPoint Dimensions = GetItemDimensions(Manifest);
+	for (const FInv_SlotAvailability& Availability : Result.SlotAvailabilities)
+	{
+		if (!IsValidIndex(Availability.Index)) continue;
+
+		if (Availability.bItemAtIndex)
+		{
+			StackCounts[Availability.Index] += Availability.AmountToFill;
+		}
+		else
+		{
+			PlaceAnchor(Availability.Index, Dimensions, Availability.AmountToFill, Manifest.GetItemType(), ItemId);
+		}
+	}
+}
+
+void FInv_SpatialGridModel::PlaceAnchor(const int32 UpperLeftIndex, const FIntPoint& Dimensions,
+                                        const int32 StackCount, const FGameplayTag& ItemType,
+                                        const FInv_ItemId ItemId)
+{
+	if (!IsValidIndex(UpperLeftIndex)) return;
+
+	const int32 Column = UpperLeftIndex % Columns;
+	const int32 Row = UpperLeftIndex / Columns;
+	const uint64 ItemRowMask = (GetWidthMask(Dimensions.X) << Column) & ColumnMask;
+	for (int32 Y = Row; Y < FMath::Min(Row + Dimensions.Y, Rows); ++Y)
+	{
+		RowMasks[Y] |= ItemRowMask;
+	}
+	AnchorMasks[Row] |= 1ull << Column;
+
+	ForEach2D(UpperLeftIndex, Dimensions, [&](const int32 Index)
+	{
+		UpperLeftIndices[Index] = UpperLeftIndex;
+	});
+
+	StackCounts[UpperLeftIndex] = StackCount;
+	ItemTypes[UpperLeftIndex] = ItemType;
+	ItemIds[UpperLeftIndex] = ItemId;
+}
+
+void FInv_SpatialGridModel::GetPlacements(const FInv_ItemId ItemId, TArray<FInv_GridPlacement>& OutPlacements) const
+{
+	OutPlacements.Reset();
+	ForEachAnchorOf(ItemId, [&](const int32 Index)
+	{
+		OutPlacements.Add(FInv_GridPlacement{Index, StackCounts[Index]});
+	});
+}
+
+void FInv_SpatialGridModel::ClearPlacements(const FInv_ItemId ItemId, const FInv_ItemManifest& Manifest)
+{
+	const FIntPoint Dimensions = GetItemDimensions(Manifest);
+	TArray<int32, TInlineAllocator<8>> Anchors;
+	ForEachAnchorOf(ItemId, [&](const int32 Index)
+	{
+		Anchors.Add(Index);
+	});
+	for (const int32 Index : Anchors)
+	{
+		ClearItem(Index, Dimensions);
+	}
+}
+
+bool FInv_SpatialGridModel::TryPlaceItem(const FInv_ItemId ItemId, const FInv_ItemManifest& Manifest,
+                                         const FInv_GridPlacement& Placement)
+{
+	if (!ItemId.IsValid()) return false;
+
+	const FIntPoint Dimensions = GetItemDimensions(Manifest);
+	if (!IsInGridBounds(Placement.Index, Dimensions)) return false;
+
+	const FIntPoint Position(Placement.Index % Columns, Placement.Index / Columns);
+	if (!IsRegionFree(Position, Dimensions)) return false;
+
+	const FInv_StackableFragment* StackableFragment = Manifest.GetFragmentOfType<FInv_StackableFragment>();
+	const bool bValidStackCount = StackableFragment
+		                              ? Placement.StackCount > 0 && Placement.StackCount <= StackableFragment->
+		                              GetMaxStackSize()
+		                              : Placement.StackCount == 0;
+	if (!bValidStackCount) return false;
+
+	PlaceAnchor(Placement.Index, Dimensions, Placement.StackCount, Manifest.GetItemType(), ItemId);
+	return true;
+}
+
+void FInv_SpatialGridModel::ClearItem(const int32 UpperLeftIndex, const FIntPoint& Dimensions)
+{
+	if (!IsValidIndex(UpperLeftIndex)) return;
+
+	const int32 Column = UpperLeftIndex % Columns;
+	const int32 Row = UpperLeftIndex / Columns;
+	const uint64 ItemRowMask = GetWidthMask(Dimensions.X) << Column;
+	for (int32 Y = Row; Y < FMath::Min(Row + Dimensions.Y, Rows); ++Y)
+	{
+		RowMasks[Y] &= ~ItemRowMask;
+		AnchorMasks[Y] &= ~ItemRowMask;
+	}
+
+	ForEach2D(UpperLeftIndex, Dimensions, [&](const int32 Index)
+	{
+		UpperLeftIndices[Index] = INDEX_NONE;
+		StackCounts[Index] = 0;
+		ItemTypes[Index] = FGameplayTag::EmptyTag;
+		ItemIds[Index] = FInv_ItemId();
+	});
+}
+
+FInv_SlotAvailabilityResult FInv_SpatialGridModel::FindRoomForItem(const FInv_ItemManifest& Manifest,
+                                                                   const TConstArrayView<FInv_ItemId> ExcludedItemIds) const
+{
+	FInv_SlotAvailabilityResult Result;
+
+	// 确定物品是否可堆叠
+	const FInv_StackableFragment* StackableFragment = Manifest.GetFragmentOfType<FInv_StackableFragment>();
+	Result.bStackable = StackableFragment != nullptr;
+
+	// 确定需要添加的堆叠总数
+	const int32 MaxStackSize = StackableFragment ? StackableFragment->GetMaxStackSize() : 1;
+	int32 AmountToFill = StackableFragment ? StackableFragment->GetStackCount() : 1;
+
+	// 尺寸与类型在整个查询中都不会变，只取一次
+	const FIntPoint Dimensions = GetItemDimensions(Manifest);
+	const FGameplayTag ItemType = Manifest.GetItemType();
+	const uint64 ItemWidthMask = GetWidthMask(Dimensions.X);
+
+	// 已经有道具的格子加上本次查询认领的格子，都不能再作为空位使用。
+	// Fit 与 Anchors 在查询开始时只计算一次，之后每认领一个空位只更新受影响的几行。
+	FRowMaskArray Blocked(RowMasks);
+	FRowMaskArray Fit;
+	FRowMaskArray Anchors;
+	if (CanFitInGrid(Dimensions))
+	{
+		BuildFreeAnchorMasks(Blocked, Dimensions, Fit, Anchors);
+	}
+
+	// 按 Index 顺序，在“空闲锚点”和“可以继续堆叠的锚点”中取靠前的那个，
+	// 认领后从下一个 Index 继续查找，直到填满或者没有可用的锚点。
+	int32 SearchIndex = 0;
+	while (AmountToFill > 0)
+	{
+		const int32 FreeIndex = SearchIndex < Num() ? FindFirstSetAnchor(Anchors, Columns, SearchIndex) : INDEX_NONE;
+		const int32 StackIndex = Result.bStackable
+			                         ? FindNextStackAnchor(SearchIndex, ItemType, MaxStackSize, ExcludedItemIds)
+			                         : INDEX_NONE;
+		if (FreeIndex == INDEX_NONE && StackIndex == INDEX_NONE) break;
+
+		const bool bItemAtIndex = StackIndex != INDEX_NONE && (FreeIndex == INDEX_NONE || StackIndex < FreeIndex);
+		const int32 Index = bItemAtIndex ? StackIndex : FreeIndex;
+
+		// 确认当前格子可以填多少数量的堆叠
+		const int32 AmountToFillInSlot = Result.bStackable
+			                                 ? FMath::Min(AmountToFill, MaxStackSize - GetStackAmount(Index))
+			                                 : 1;
+
+		// 认领道具要占用的格子，只有占用的行的 Fit 和往上 Height - 1 行的锚点会变化
+		if (!bItemAtIndex)
+		{
+			const int32 Column = Index % Columns;
+			const int32 Row = Index / Columns;
+			const int32 EndRow = FMath::Min(Row + Dimensions.Y, Rows);
+			for (int32 Y = Row; Y < EndRow; ++Y)
+			{
+				Blocked[Y] |= ItemWidthMask << Column;
+				Fit[Y] = GetRowFit(Blocked[Y], ColumnMask, Dimensions.X);
+			}
+
+			const int32 FirstAnchorRow = FMath::Max(Row - Dimensions.Y + 1, 0);
+			const int32 EndAnchorRow = FMath::Min(EndRow, Anchors.Num());
+			AndRowsVertically(Anchors.GetData() + FirstAnchorRow, Fit.GetData() + FirstAnchorRow,
+			                  EndAnchorRow - FirstAnchorRow, Dimensions.Y);
+		}
+
+		// 把当前格子上的信息添加到 Result 中
+		Result.TotalRoomToFill += AmountToFillInSlot;
+		Result.SlotAvailabilities.Emplace(
+			FInv_SlotAvailability{
+				Index,
+				Result.bStackable ? AmountToFillInSlot : 0,
+				bItemAtIndex
+			}
+		);
+
+		AmountToFill -= AmountToFillInSlot;
+
+		// 还有要添加的道具吗？没有就返回结果，有就继续找下一个格子的信息。
+		Result.Remainder = AmountToFill;
+		SearchIndex = Index + 1;
+	}
+
+	return Result;
+}
+
+int32 FInv_SpatialGridModel::FindFreeAnchorForItem(const FInv_ItemManifest& Manifest) const
+{
+	return FindFirstFreeAnchor(RowMasks, GetItemDimensions(Manifest), 0);
+}
+
+int32 FInv_SpatialGridModel::FindFirstFreeAnchor(const TArrayView<const uint64> Blocked, const FIntPoint& Dimensions,
+                                                 const int32 StartIndex) const
+{
+	if (!CanFitInGrid(Dimensions) || StartIndex >= Num()) return INDEX_NONE;
+
+	FRowMaskArray Fit;
+	FRowMaskArray Anchors;
+	BuildFreeAnchorMasks(Blocked, Dimensions, Fit, Anchors);
+	return FindFirstSetAnchor(Anchors, Columns, StartIndex);
+}
+
+bool FInv_SpatialGridModel::CanFitInGrid(const FIntPoint& Dimensions) const
+{
+	return Dimensions.X > 0 && Dimensions.Y > 0 && Dimensions.X <= Columns && Dimensions.Y <= Rows;
+}
+
+void FInv_SpatialGridModel::BuildFreeAnchorMasks(const TArrayView<const uint64> Blocked, const FIntPoint& Dimensions,
+                                                 FRowMaskArray& OutFit, FRowMaskArray& OutAnchors) const
+{
+	OutFit.SetNumUninitialized(Rows);
+	for (int32 Y = 0; Y < Rows; ++Y)
+	{
+		OutFit[Y] = GetRowFit(Blocked[Y], ColumnMask, Dimensions.X);
+	}
+
+	// 纵向：锚点所在行往下 Height 行都要能放下
+	const int32 NumAnchorRows = Rows - Dimensions.Y + 1;
+	OutAnchors.SetNumUninitialized(NumAnchorRows);
+	AndRowsVertically(OutAnchors.GetData(), OutFit.GetData(), NumAnchorRows, Dimensions.Y);
+}
+
+int32 FInv_SpatialGridModel::FindNextStackAnchor(const int32 StartIndex, const FGameplayTag& ItemType,
+                                                 const int32 MaxStackSize,
+                                                 const TConstArrayView<FInv_ItemId> ExcludedItemIds) const
+{
+	if (StartIndex >= Num()) return INDEX_NONE;
+
+	// 只需要检查锚点：对于可堆叠的多格物品，堆叠时只允许在该物品的锚点上进行
+	const int32 StartRow = FMath::Max(StartIndex, 0) / Columns;
+	const int32 StartColumn = FMath::Max(StartIndex, 0) % Columns;
+	for (int32 Y = StartRow; Y < Rows; ++Y)
+	{
+		uint64 RowAnchors = Y == StartRow ? AnchorMasks[Y] & (~0ull << StartColumn) : AnchorMasks[Y];
+		while (RowAnchors != 0)
+		{
+			const int32 Index = Y * Columns + static_cast<int32>(FMath::CountTrailingZeros64(RowAnchors));
+			RowAnchors &= RowAnchors - 1;
+
+			// 类型相同，且没有达到堆叠上限
+			if (!ItemTypes[Index].MatchesTagExact(ItemType) || StackCounts[Index] >= MaxStackSize) continue;
+
+			// 同一批次中新加入的道具不能作为堆叠目标，否则客户端的规划（新道具还没有 ID）与服务器会不一致
+			const FInv_ItemId& AnchorItemId = ItemIds[Index];
+			if (AnchorItemId.IsValid() && !ExcludedItemIds.Contains(AnchorItemId))
+			{
+				return Index;
+			}
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 FInv_SpatialGridModel::GetStackAmount(const int32 Index) const
+{
+	const int32 UpperLeftIndex = UpperLeftIndices[Index];
+	return UpperLeftIndex != INDEX_NONE ? StackCounts[UpperLeftIndex] : StackCounts[Index];
+}
+
+bool FInv_SpatialGridModel::IsRegionFree(const FIntPoint& Position, const FIntPoint& Dimensions) const
+{
+	const uint64 ItemRowMask = GetWidthMask(Dimensions.X) << Position.X;
+	for (int32 Y = Position.Y; Y < FMath::Min(Position.Y + Dimensions.Y, Rows); ++Y)
+	{
+		if (RowMasks[Y] & ItemRowMask) return false;
+	}
+	return true;
+}
+
+FInv_SpaceQueryResult FInv_SpatialGridModel::QuerySpace(const FIntPoint& Position, const FIntPoint& Dimensions) const
+{
+	FInv_SpaceQueryResult QueryResult;
+
+	// 在 Grid 范围内吗？
+	if (Position.X < 0 || Position.Y < 0) return QueryResult;
+	const int32 StartIndex = Position.X + Position.Y * Columns;
+	if (!IsInGridBounds(StartIndex, Dimensions)) return QueryResult;
+
+	// 整片区域都空闲时不需要再逐格检查
+	QueryResult.bHasSpace = IsRegionFree(Position, Dimensions);
+	if (QueryResult.bHasSpace) return QueryResult;
+
+	// 这里有道具吗？若有物品，是否仅唯一一个道具覆盖了这片区域？
+	// - 因为正在拖动的道具可能会覆盖住一片区域，该区域可能有多个道具的锚点在
+	int32 OccupiedUpperLeftIndex = INDEX_NONE;
+	bool bMultipleItems = false;
+	ForEach2D(StartIndex, Dimensions, [&](const int32 Index)
+	{
+		const int32 UpperLeftIndex = UpperLeftIndices[Index];
+		if (UpperLeftIndex == INDEX_NONE) return;
+
+		if (OccupiedUpperLeftIndex == INDEX_NONE)
+		{
+			OccupiedUpperLeftIndex = UpperLeftIndex;
+		}
+		else if (OccupiedUpperLeftIndex != UpperLeftIndex)
+		{
+			bMultipleItems = true;
+		}
+	});
+
+	// 只有一个道具在这个位置上 —— 可以交换或者合并
+	if (OccupiedUpperLeftIndex != INDEX_NONE && !bMultipleItems)
+	{
+		QueryResult.ItemId = ItemIds[OccupiedUpperLeftIndex];
+		QueryResult.UpperLeftIndex = OccupiedUpperLeftIndex;
+	}
+
+	return QueryResult;
+}
@@ -3,7 +3,11 @@
 
 #include "Items/Components/Inv_ItemComponent.h"
 
+#include "Interaction/Inv_PickupSubsystem.h"
+#include "Items/Definition/Inv_ItemDefinition.h"
+#include "Items/Fragments/Inv_ItemFragment.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 
 UInv_ItemComponent::UInv_ItemComponent()
@@ -16,7 +20,86 @@ void UInv_ItemComponent::GetLifetimeReplicatedProps(TArray<class FLifetimeProper
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ThisClass, ItemManifest);
+	// 场景中的道具很多且几乎不变，使用 Push Model，只有修改过的属性才会被比较和发送
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ItemDefinition, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ItemManifest, Params);
+}
+
+void UInv_ItemComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UInv_PickupSubsystem* PickupSubsystem = UInv_PickupSubsystem::Get(this))
+	{
+		PickupSubsystem->RegisterPickup(this);
+	}
+	if (USceneComponent* Root = GetOwner()->GetRootComponent())
+	{
+		Root->TransformUpdated.AddUObject(this, &ThisClass::OnOwnerTransformUpdated);
+	}
+}
+
+void UInv_ItemComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USceneComponent* Root = GetOwner()->GetRootComponent())
+	{
+		Root->TransformUpdated.RemoveAll(this);
+	}
+	if (UInv_PickupSubsystem* PickupSubsystem = UInv_PickupSubsystem::Get(this))
+	{
+		PickupSubsystem->UnregisterPickup(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+const FInv_ItemManifest& UInv_ItemComponent::GetItemManifest() const
+{
+	return IsValid(ItemDefinition) ? ItemDefinition->GetItemManifest() : ItemManifest;
+}
+
+FInv_ItemManifest& UInv_ItemComponent::GetMutableItemManifest()
+{
+	if (IsValid(ItemDefinition))
+	{
+		ItemManifest = ItemDefinition->GetItemManifest();
+		ItemDefinition = nullptr;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemDefinition, this);
+	}
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemManifest, this);
+	return ItemManifest;
+}
+
+void UInv_ItemComponent::InitializeDroppedItem(UInv_ItemDefinition* InItemDefinition,
+                                               const FInv_ItemManifest& InItemManifest, const int32 StackCount)
+{
+	ItemDefinition = InItemDefinition;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemDefinition, this);
+	if (!IsValid(ItemDefinition))
+	{
+		ItemManifest = InItemManifest;
+		MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemManifest, this);
+	}
+
+	const FInv_StackableFragment* StackableFragment = GetItemManifest().GetFragmentOfType<FInv_StackableFragment>();
+	if (!StackableFragment || StackableFragment->GetStackCount() == StackCount) return;
+
+	GetMutableItemManifest().GetMutableFragmentOfType<FInv_StackableFragment>()->SetStackCount(StackCount);
+}
+
+#if WITH_EDITOR
+void UInv_ItemComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	ItemManifest.InvalidateFragmentLookup();
+}
+#endif
+
+void UInv_ItemComponent::OnRep_ItemManifest()
+{
+	ItemManifest.InvalidateFragmentLookup();
 }
 
 void UInv_ItemComponent::PickedUp()
@@ -24,3 +107,12 @@ void UInv_ItemComponent::PickedUp()
 	OnPickedUp();
 	GetOwner()->Destroy();
 }
+
+void UInv_ItemComponent::OnOwnerTransformUpdated(USceneComponent* UpdatedComponent,
+                                                 EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UInv_PickupSubsystem* PickupSubsystem = UInv_PickupSubsystem::Get(this))
+	{
+		PickupSubsystem->UpdatePickup(this);
+	}
+}
@@ -0,0 +1,29 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/Definition/Inv_ItemDefinition.h"
+
+#include "Items/Inv_InventoryItem.h"
+
+const FPrimaryAssetType UInv_ItemDefinition::PrimaryAssetType(TEXT("Inv_ItemDefinition"));
+
+FPrimaryAssetId UInv_ItemDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+#if WITH_EDITOR
+void UInv_ItemDefinition::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	ItemManifest.InvalidateFragmentLookup();
+}
+#endif
+
+UInv_InventoryItem* UInv_ItemDefinition::Manifest(UObject* NewOuter)
+{
+	UInv_InventoryItem* Item = NewObject<UInv_InventoryItem>(NewOuter, UInv_InventoryItem::StaticClass());
+	Item->SetItemDefinition(this);
+
+	return Item;
+}
@@ -3,25 +3,62 @@
 
 #include "Items/Inv_InventoryItem.h"
 
+#include "InventoryManagement/Components/Inv_InventoryComponent.h"
 #include "InventoryManagement/Utils/Inv_InventoryStatics.h"
-#include "Items/Fragments/Inv_ItemFragment.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
 
 void UInv_InventoryItem::GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const
 {
 	UObject::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ThisClass, ItemManifest);
-	DOREPLIFETIME(ThisClass, TotalStackCount);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, Instance, Params);
+	DOREPLIFETIME_WITH_PARAMS_FAST(ThisClass, ItemId, Params);
 }
 
 void UInv_InventoryItem::SetItemManifest(const FInv_ItemManifest& Manifest)
 {
-	ItemManifest = FInstancedStruct::Make<FInv_ItemManifest>(Manifest);
+	Instance.SetItemManifest(Manifest);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Instance, this);
 }
 
-bool UInv_InventoryItem::IsStackable() const
+void UInv_InventoryItem::SetItemManifest(FInv_ItemManifest&& Manifest)
 {
-	const FInv_StackableFragment* StackableFragment = GetItemManifest().GetFragmentOfType<FInv_StackableFragment>();
-	return StackableFragment != nullptr;
+	Instance.SetItemManifest(MoveTemp(Manifest));
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Instance, this);
+}
+
+void UInv_InventoryItem::SetItemDefinition(UInv_ItemDefinition* InDefinition)
+{
+	Instance.SetItemDefinition(InDefinition);
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Instance, this);
+}
+
+FInv_ItemManifest& UInv_InventoryItem::GetMutableManifest()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, Instance, this);
+	return Instance.GetMutableManifest();
+}
+
+void UInv_InventoryItem::SetItemId(const FInv_ItemId InItemId)
+{
+	if (ItemId == InItemId) return;
+
+	ItemId = InItemId;
+	MARK_PROPERTY_DIRTY_FROM_NAME(ThisClass, ItemId, this);
+}
+
+void UInv_InventoryItem::OnRep_Instance()
+{
+	Instance.PostReplicatedUpdate();
+
+	// 道具的 Outer 是拥有道具栏的 PlayerController
+	if (UInv_InventoryComponent* InventoryComponent = UInv_InventoryStatics::GetInventoryComponent(
+		Cast<APlayerController>(GetOuter())))
+	{
+		InventoryComponent->OnItemChanged.Broadcast(FInv_ItemHandle(InventoryComponent, ItemId),
+		                                            EInv_ItemChangeFlags::Fragments);
+	}
 }
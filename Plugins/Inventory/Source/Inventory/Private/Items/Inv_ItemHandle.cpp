@@ -0,0 +1,45 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/Inv_ItemHandle.h"
+
+#include "InventoryManagement/Components/Inv_InventoryComponent.h"
+#include "Items/Manifest/Inv_ItemManifest.h"
+
+FInv_ItemHandle::FInv_ItemHandle(const UInv_InventoryComponent* InInventory, const FInv_ItemId InItemId)
+	: Inventory(InInventory)
+	  , ItemId(InItemId)
+{
+}
+
+const FInv_InventoryEntry* FInv_ItemHandle::FindEntry() const
+{
+	if (!ItemId.IsValid()) return nullptr;
+
+	const UInv_InventoryComponent* InventoryComponent = Inventory.Get();
+	return InventoryComponent ? InventoryComponent->FindItemEntry(ItemId) : nullptr;
+}
+
+const FInv_ItemManifest& FInv_ItemHandle::GetItemManifest() const
+{
+	const FInv_InventoryEntry* Entry = FindEntry();
+	return Entry ? Entry->GetItemManifest() : FInv_ItemManifest::GetEmpty();
+}
+
+int32 FInv_ItemHandle::GetTotalStackCount() const
+{
+	const FInv_InventoryEntry* Entry = FindEntry();
+	return Entry ? Entry->GetTotalStackCount() : 0;
+}
+
+bool FInv_ItemHandle::IsStackable() const
+{
+	const FInv_InventoryEntry* Entry = FindEntry();
+	return Entry && Entry->IsStackable();
+}
+
+UInv_InventoryItem* FInv_ItemHandle::GetItemObject() const
+{
+	const FInv_InventoryEntry* Entry = FindEntry();
+	return Entry ? Entry->GetItemObject() : nullptr;
+}
@@ -0,0 +1,61 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Items/Inv_ItemInstance.h"
+
+#include "Items/Definition/Inv_ItemDefinition.h"
+#include "Items/Fragments/Inv_ItemFragment.h"
+
+void FInv_ItemInstance::SetItemManifest(const FInv_ItemManifest& Manifest)
+{
+	ItemManifest.InitializeAs<FInv_ItemManifest>(Manifest);
+}
+
+void FInv_ItemInstance::SetItemManifest(FInv_ItemManifest&& Manifest)
+{
+	ItemManifest.InitializeAs<FInv_ItemManifest>(MoveTemp(Manifest));
+}
+
+void FInv_ItemInstance::SetItemDefinition(UInv_ItemDefinition* InDefinition)
+{
+	Definition = InDefinition;
+	ItemManifest.Reset();
+}
+
+const FInv_ItemManifest& FInv_ItemInstance::GetItemManifest() const
+{
+	if (const FInv_ItemManifest* Manifest = ItemManifest.GetPtr<FInv_ItemManifest>())
+	{
+		return *Manifest;
+	}
+	return IsValid(Definition) ? Definition->GetItemManifest() : FInv_ItemManifest::GetEmpty();
+}
+
+FInv_ItemManifest& FInv_ItemInstance::GetMutableManifest()
+{
+	if (!ItemManifest.IsValid())
+	{
+		if (IsValid(Definition))
+		{
+			ItemManifest.InitializeAs<FInv_ItemManifest>(Definition->GetItemManifest());
+		}
+		else
+		{
+			ItemManifest.InitializeAs<FInv_ItemManifest>();
+		}
+	}
+	return ItemManifest.GetMutable<FInv_ItemManifest>();
+}
+
+bool FInv_ItemInstance::IsStackable() const
+{
+	return GetItemManifest().GetFragmentOfType<FInv_StackableFragment>() != nullptr;
+}
+
+void FInv_ItemInstance::PostReplicatedUpdate() const
+{
+	if (const FInv_ItemManifest* Manifest = ItemManifest.GetPtr<FInv_ItemManifest>())
+	{
+		Manifest->InvalidateFragmentLookup();
+	}
+}
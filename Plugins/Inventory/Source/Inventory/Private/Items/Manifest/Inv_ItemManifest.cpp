@@ -1,11 +1,121 @@
 #include "Items/Manifest/Inv_ItemManifest.h"
 
+#include "Inventory.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
 #include "Items/Inv_InventoryItem.h"
+#include "Items/Fragments/Inv_ItemFragment.h"
 
-UInv_InventoryItem* FInv_ItemManifest::Manifest(UObject* NewOuter)
+FInv_ItemManifest::FInv_ItemManifest(const FInv_ItemManifest& Other)
+	: Fragments(Other.Fragments), ItemCategory(Other.ItemCategory), ItemType(Other.ItemType)
+{
+	INC_DWORD_STAT(STAT_Inv_ManifestCopies);
+}
+
+FInv_ItemManifest& FInv_ItemManifest::operator=(const FInv_ItemManifest& Other)
+{
+	if (this != &Other)
+	{
+		Fragments = Other.Fragments;
+		ItemCategory = Other.ItemCategory;
+		ItemType = Other.ItemType;
+		InvalidateFragmentLookup();
+		INC_DWORD_STAT(STAT_Inv_ManifestCopies);
+	}
+	return *this;
+}
+
+const FInv_ItemManifest& FInv_ItemManifest::GetEmpty()
+{
+	static const FInv_ItemManifest EmptyManifest;
+	return EmptyManifest;
+}
+
+UInv_InventoryItem* FInv_ItemManifest::Manifest(UObject* NewOuter) const
 {
 	UInv_InventoryItem* Item = NewObject<UInv_InventoryItem>(NewOuter, UInv_InventoryItem::StaticClass());
 	Item->SetItemManifest(*this);
 
 	return Item;
 }
+
+void FInv_ItemManifest::InvalidateFragmentLookup() const
+{
+	FragmentLookup.Reset();
+	FragmentLookupSourceNum = INDEX_NONE;
+}
+
+void FInv_ItemManifest::PostSerialize(const FArchive& Ar)
+{
+	if (Ar.IsLoading())
+	{
+		InvalidateFragmentLookup();
+	}
+}
+
+int32 FInv_ItemManifest::FindFragmentIndex(const UScriptStruct* Type, const FGameplayTag* FragmentTag) const
+{
+	if (FragmentLookupSourceNum != Fragments.Num())
+	{
+		BuildFragmentLookup();
+	}
+
+	bool bStale = false;
+	const int32 FragmentIndex = FindFragmentIndexInLookup(Type, FragmentTag, bStale);
+	if (!bStale) return FragmentIndex;
+
+	// Fragments 在数量不变的情况下被替换了（比如编辑器里换了某个 Fragment 的类型），重新构建后再查
+	BuildFragmentLookup();
+	return FindFragmentIndexInLookup(Type, FragmentTag, bStale);
+}
+
+int32 FInv_ItemManifest::FindFragmentIndexInLookup(const UScriptStruct* Type, const FGameplayTag* FragmentTag,
+                                                   bool& bOutStale) const
+{
+	bOutStale = false;
+
+	const int32 First = Algo::LowerBoundBy(FragmentLookup, Type, &FInv_FragmentLookupEntry::Type);
+	for (int32 LookupIndex = First; LookupIndex < FragmentLookup.Num(); ++LookupIndex)
+	{
+		const FInv_FragmentLookupEntry& Entry = FragmentLookup[LookupIndex];
+		if (Entry.Type != Type) break;
+		if (FragmentTag && !Entry.FragmentTag.MatchesTagExact(*FragmentTag)) continue;
+
+		if (!Fragments.IsValidIndex(Entry.FragmentIndex) ||
+			Fragments[Entry.FragmentIndex].GetScriptStruct() != Entry.FragmentType)
+		{
+			bOutStale = true;
+			return INDEX_NONE;
+		}
+		return Entry.FragmentIndex;
+	}
+	return INDEX_NONE;
+}
+
+void FInv_ItemManifest::BuildFragmentLookup() const
+{
+	FragmentLookup.Reset();
+
+	const UScriptStruct* BaseStruct = FInv_ItemFragment::StaticStruct();
+	for (int32 FragmentIndex = 0; FragmentIndex < Fragments.Num(); ++FragmentIndex)
+	{
+		const TInstancedStruct<FInv_ItemFragment>& Fragment = Fragments[FragmentIndex];
+		const FInv_ItemFragment* FragmentPtr = Fragment.GetPtr<FInv_ItemFragment>();
+		if (!FragmentPtr) continue;
+
+		// 为 Fragment 的类型及其所有父类型（直到 FInv_ItemFragment）各登记一项
+		const UScriptStruct* FragmentType = Fragment.GetScriptStruct();
+		for (const UStruct* Type = FragmentType; Type; Type = Type->GetSuperStruct())
+		{
+			FragmentLookup.Add({
+				static_cast<const UScriptStruct*>(Type), FragmentType, FragmentPtr->GetFragmentTag(), FragmentIndex
+			});
+			if (Type == BaseStruct) break;
+		}
+	}
+
+	// 稳定排序，同一类型的项仍然按 Fragments 中的顺序排列，查找结果与线性扫描一致
+	Algo::StableSortBy(FragmentLookup, &FInv_FragmentLookupEntry::Type);
+
+	FragmentLookupSourceNum = Fragments.Num();
+}
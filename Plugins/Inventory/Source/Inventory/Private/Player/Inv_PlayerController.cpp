@@ -6,23 +6,19 @@
 #include "EnhancedInputSubsystems.h"
 #include "InputMappingContext.h"
 #include "Blueprint/UserWidget.h"
+#include "Inventory.h"
 #include "Interaction/Inv_Highlightable.h"
+#include "Interaction/Inv_PickupSubsystem.h"
 #include "InventoryManagement/Components/Inv_InventoryComponent.h"
 #include "Items/Components/Inv_ItemComponent.h"
 #include "Widgets/HUD/Inv_HUDWidget.h"
 
 AInv_PlayerController::AInv_PlayerController()
 {
-	PrimaryActorTick.bCanEverTick = true;
 	TraceLength = 1000.f;
-	TraceChannel = ECC_GameTraceChannel2;
-}
-
-void AInv_PlayerController::Tick(float DeltaSeconds)
-{
-	Super::Tick(DeltaSeconds);
-
-	TraceForItem();
+	TargetingConeAngle = 10.f;
+	OcclusionChannel = ECC_Visibility;
+	MaxOcclusionTraces = 4;
 }
 
 void AInv_PlayerController::ToggleInventory()
@@ -31,6 +27,11 @@ void AInv_PlayerController::ToggleInventory()
 	InventoryComponent->ToggleInventoryMenu();
 }
 
+bool AInv_PlayerController::IsInventoryMenuOpen() const
+{
+	return InventoryComponent.IsValid() && InventoryComponent->IsInventoryMenuOpen();
+}
+
 void AInv_PlayerController::BeginPlay()
 {
 	Super::BeginPlay();
@@ -51,6 +52,25 @@ void AInv_PlayerController::BeginPlay()
 	InventoryComponent = FindComponentByClass<UInv_InventoryComponent>();
 
 	CreateHUDWidget();
+
+	// 只有本地玩家需要拾取提示，服务器上的远端 Controller 不做查找
+	if (IsLocalController())
+	{
+		if (UInv_PickupSubsystem* PickupSubsystem = UInv_PickupSubsystem::Get(this))
+		{
+			PickupSubsystem->RegisterScanner(this);
+		}
+	}
+}
+
+void AInv_PlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UInv_PickupSubsystem* PickupSubsystem = UInv_PickupSubsystem::Get(this))
+	{
+		PickupSubsystem->UnregisterScanner(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AInv_PlayerController::SetupInputComponent()
@@ -85,25 +105,29 @@ void AInv_PlayerController::CreateHUDWidget()
 	}
 }
 
-void AInv_PlayerController::TraceForItem()
+void AInv_PlayerController::TraceForItem(const FVector& ViewLocation, const FRotator& ViewRotation)
 {
-	if (!GEngine || !GEngine->GameViewport) return;
-
-	FVector2D ViewportSize;
-	GEngine->GameViewport->GetViewportSize(ViewportSize);
+	const UInv_PickupSubsystem* PickupSubsystem = UInv_PickupSubsystem::Get(this);
+	if (!PickupSubsystem) return;
 
-	const FVector2D ScreenCenter = ViewportSize / 2.0f;
-	FVector TraceStart;
-	FVector TraceDirection;
-	if (!DeprojectScreenPositionToWorld(ScreenCenter.X, ScreenCenter.Y, TraceStart, TraceDirection)) return;
+	TArray<FInv_PickupCandidate> Candidates;
+	PickupSubsystem->FindPickupsInView(ViewLocation, ViewRotation.Vector(), TraceLength, TargetingConeAngle,
+	                                   Candidates);
 
-	const FVector TraceEnd = TraceStart + TraceDirection * TraceLength;
-
-	FHitResult HitResult;
-	GetWorld()->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd, TraceChannel);
+	AActor* TargetActor = nullptr;
+	const int32 NumTraces = FMath::Min(Candidates.Num(), MaxOcclusionTraces);
+	for (int32 Index = 0; Index < NumTraces; ++Index)
+	{
+		AActor* Pickup = Candidates[Index].ItemComponent->GetOwner();
+		if (IsPickupVisible(ViewLocation, Pickup, Candidates[Index].TargetLocation))
+		{
+			TargetActor = Pickup;
+			break;
+		}
+	}
 
 	LastActor = ThisActor;
-	ThisActor = HitResult.GetActor();
+	ThisActor = TargetActor;
 
 	if (!ThisActor.IsValid())
 	{
@@ -135,3 +159,18 @@ void AInv_PlayerController::TraceForItem()
 		}
 	}
 }
+
+bool AInv_PlayerController::IsPickupVisible(const FVector& ViewLocation, const AActor* Pickup,
+                                            const FVector& TargetLocation) const
+{
+	INC_DWORD_STAT(STAT_Inv_OcclusionTraces);
+
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(Inv_PickupOcclusion), false, GetPawn());
+
+	FHitResult HitResult;
+	if (!GetWorld()->LineTraceSingleByChannel(HitResult, ViewLocation, TargetLocation, OcclusionChannel, QueryParams))
+	{
+		return true;
+	}
+	return HitResult.GetActor() == Pickup;
+}
@@ -0,0 +1,201 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "InventoryManagement/Spatial/Inv_SpatialGridModel.h"
+#include "Items/Inv_ItemTags.h"
+#include "Items/Fragments/Inv_ItemFragment.h"
+#include "Items/Manifest/Inv_ItemManifest.h"
+
+namespace Inv_SpatialGridModelTests
+{
+	constexpr EAutomationTestFlags TestFlags = EAutomationTestFlags_ApplicationContextMask |
+		EAutomationTestFlags::EngineFilter;
+
+	/** 不可堆叠的道具，占据 Size 大小的格子 */
+	FInv_ItemManifest MakeItem(const FIntPoint& Size)
+	{
+		FInv_ItemManifest Manifest(EInv_ItemCategory::Equippable, GameItemsAdd::Equipment::Weapons::Axe);
+		Manifest.AddFragment<FInv_GridFragment>().SetGridSize(Size);
+		return Manifest;
+	}
+
+	/** 1x1 的可堆叠道具，一次加入 StackCount 个 */
+	FInv_ItemManifest MakeStackableItem(const int32 MaxStackSize, const int32 StackCount)
+	{
+		FInv_ItemManifest Manifest(EInv_ItemCategory::Consumable, GameItemsAdd::Consumables::Potions::Red::Small);
+		Manifest.AddFragment<FInv_GridFragment>();
+		FInv_StackableFragment& Stackable = Manifest.AddFragment<FInv_StackableFragment>();
+		Stackable.SetMaxStackSize(MaxStackSize);
+		Stackable.SetStackCount(StackCount);
+		return Manifest;
+	}
+}
+
+using namespace Inv_SpatialGridModelTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInv_SpatialGridModelFirstFitTest, "Inventory.SpatialGridModel.FirstFit", TestFlags)
+
+bool FInv_SpatialGridModelFirstFitTest::RunTest(const FString& Parameters)
+{
+	// 4 x 4，(0, 0) 被一个 1x1 道具占用
+	FInv_SpatialGridModel Model;
+	Model.Initialize(4, 4);
+	TestTrue(TEXT("1x1 item placed at 0"), Model.TryPlaceItem(FInv_ItemId(1), MakeItem({1, 1}), {0, 0}));
+
+	// 2x2 道具按 Index 顺序放在第一个能完整放下的位置
+	const FInv_ItemManifest Large = MakeItem({2, 2});
+	const FInv_SlotAvailabilityResult First = Model.FindRoomForItem(Large);
+	TestEqual(TEXT("Room for one 2x2 item"), First.TotalRoomToFill, 1);
+	if (!TestEqual(TEXT("One slot"), First.SlotAvailabilities.Num(), 1)) return false;
+	TestEqual(TEXT("First fit skips the occupied cell"), First.SlotAvailabilities[0].Index, 1);
+	TestFalse(TEXT("Free anchor, not a stack"), First.SlotAvailabilities[0].bItemAtIndex);
+
+	// 占用 (1, 0) - (2, 1) 之后，第 0 行剩下的一列放不下，第 1 行的 (0, 1) 与占用区域重叠，应该放到第 2 行
+	TestTrue(TEXT("2x2 item placed at 1"), Model.TryPlaceItem(FInv_ItemId(2), Large, {1, 0}));
+	TestEqual(TEXT("Next 2x2 anchor"), Model.FindFreeAnchorForItem(Large), 8);
+
+	// 比网格还大的道具没有任何位置
+	const FInv_SlotAvailabilityResult TooLarge = Model.FindRoomForItem(MakeItem({5, 1}));
+	TestEqual(TEXT("No room for an item wider than the grid"), TooLarge.TotalRoomToFill, 0);
+	TestEqual(TEXT("Remainder of an item wider than the grid"), TooLarge.Remainder, 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInv_SpatialGridModelStackFillTest, "Inventory.SpatialGridModel.StackFill", TestFlags)
+
+bool FInv_SpatialGridModelStackFillTest::RunTest(const FString& Parameters)
+{
+	// 1 x 2，第一格已经有 3 个同类道具，上限是 5
+	FInv_SpatialGridModel Model;
+	Model.Initialize(1, 2);
+	TestTrue(TEXT("Existing stack placed"), Model.TryPlaceItem(FInv_ItemId(1), MakeStackableItem(5, 3), {0, 3}));
+
+	// 加入 9 个：先补满已有的堆叠（2 个），再占用空格（5 个），剩下 2 个放不下
+	const FInv_SlotAvailabilityResult Result = Model.FindRoomForItem(MakeStackableItem(5, 9));
+	TestTrue(TEXT("Stackable"), Result.bStackable);
+	TestEqual(TEXT("Total room"), Result.TotalRoomToFill, 7);
+	TestEqual(TEXT("Remainder"), Result.Remainder, 2);
+	if (!TestEqual(TEXT("Two slots"), Result.SlotAvailabilities.Num(), 2)) return false;
+
+	TestEqual(TEXT("Existing stack index"), Result.SlotAvailabilities[0].Index, 0);
+	TestTrue(TEXT("Existing stack is an item"), Result.SlotAvailabilities[0].bItemAtIndex);
+	TestEqual(TEXT("Existing stack fill"), Result.SlotAvailabilities[0].AmountToFill, 2);
+	TestEqual(TEXT("Free slot index"), Result.SlotAvailabilities[1].Index, 1);
+	TestFalse(TEXT("Free slot is empty"), Result.SlotAvailabilities[1].bItemAtIndex);
+	TestEqual(TEXT("Free slot fill"), Result.SlotAvailabilities[1].AmountToFill, 5);
+
+	// 被排除的道具不能作为堆叠目标
+	const FInv_ItemId Excluded[] = {FInv_ItemId(1)};
+	const FInv_SlotAvailabilityResult WithExclusion = Model.FindRoomForItem(MakeStackableItem(5, 9), Excluded);
+	TestEqual(TEXT("Excluded stack is skipped"), WithExclusion.TotalRoomToFill, 5);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInv_SpatialGridModelReserveRoomTest, "Inventory.SpatialGridModel.ReserveRoom",
+                                 TestFlags)
+
+bool FInv_SpatialGridModelReserveRoomTest::RunTest(const FString& Parameters)
+{
+	FInv_SpatialGridModel Model;
+	Model.Initialize(2, 3);
+
+	// 规划中预留的格子没有 ID，但之后的查询必须把它们当作已占用
+	const FInv_ItemManifest Wide = MakeItem({2, 1});
+	const FInv_SlotAvailabilityResult First = Model.FindRoomForItem(Wide);
+	Model.ReserveRoom(First, Wide);
+	TestTrue(TEXT("Reserved cell 0"), Model.IsOccupied(0));
+	TestTrue(TEXT("Reserved cell 1"), Model.IsOccupied(1));
+	TestFalse(TEXT("Reserved cells have no item ID"), Model.GetItemId(1).IsValid());
+
+	const FInv_SlotAvailabilityResult Second = Model.FindRoomForItem(Wide);
+	if (!TestEqual(TEXT("One slot"), Second.SlotAvailabilities.Num(), 1)) return false;
+	TestEqual(TEXT("Second item goes to the next row"), Second.SlotAvailabilities[0].Index, 3);
+
+	// 没有 ID 的预留堆叠不会作为堆叠目标，后面的同类道具在客户端和服务器上都会被当作新道具
+	const FInv_ItemManifest Potion = MakeStackableItem(5, 1);
+	Model.ReserveRoom(Model.FindRoomForItem(Potion), Potion);
+	TestEqual(TEXT("Reserved stack anchor"), Model.GetStackCount(2), 1);
+
+	const FInv_SlotAvailabilityResult NextPotion = Model.FindRoomForItem(Potion);
+	if (!TestEqual(TEXT("One potion slot"), NextPotion.SlotAvailabilities.Num(), 1)) return false;
+	TestFalse(TEXT("Reserved stack is not a stack target"), NextPotion.SlotAvailabilities[0].bItemAtIndex);
+	TestEqual(TEXT("Next potion goes to the next free cell"), NextPotion.SlotAvailabilities[0].Index, 3);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInv_SpatialGridModelFullWidthTest, "Inventory.SpatialGridModel.FullWidth",
+                                 TestFlags)
+
+bool FInv_SpatialGridModelFullWidthTest::RunTest(const FString& Parameters)
+{
+	// 64 列：一行正好用满一个 uint64，最高位就是最后一列
+	constexpr int32 Columns = FInv_SpatialGridModel::MaxColumns;
+	FInv_SpatialGridModel Model;
+	Model.Initialize(2, Columns);
+
+	const FInv_ItemManifest Small = MakeItem({1, 1});
+	for (int32 Column = 0; Column < Columns - 1; ++Column)
+	{
+		Model.TryPlaceItem(FInv_ItemId(Column + 1), Small, {Column, 0});
+	}
+	TestEqual(TEXT("Last column is the first free anchor"), Model.FindFreeAnchorForItem(Small), Columns - 1);
+	TestEqual(TEXT("2x1 item doesn't wrap around the row"), Model.FindFreeAnchorForItem(MakeItem({2, 1})), Columns);
+
+	TestTrue(TEXT("Placed in the last column"), Model.TryPlaceItem(FInv_ItemId(Columns), Small, {Columns - 1, 0}));
+	TestTrue(TEXT("Last column occupied"), Model.IsOccupied(Columns - 1));
+	TestFalse(TEXT("Next row untouched"), Model.IsOccupied(Columns));
+
+	const FInv_ItemManifest FullRow = MakeItem({Columns, 1});
+	TestEqual(TEXT("Full-width item fits in the empty row"), Model.FindFreeAnchorForItem(FullRow), Columns);
+	TestTrue(TEXT("Full-width item placed"), Model.TryPlaceItem(FInv_ItemId(Columns + 1), FullRow, {Columns, 0}));
+	TestTrue(TEXT("Last cell occupied"), Model.IsOccupied(Model.Num() - 1));
+
+	Model.ClearItem(Columns, {Columns, 1});
+	TestFalse(TEXT("Full-width item cleared"), Model.IsOccupied(Model.Num() - 1));
+	TestTrue(TEXT("Row above untouched by the clear"), Model.IsOccupied(Columns - 1));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInv_SpatialGridModelRoundTripTest, "Inventory.SpatialGridModel.ClearAndPlace",
+                                 TestFlags)
+
+bool FInv_SpatialGridModelRoundTripTest::RunTest(const FString& Parameters)
+{
+	FInv_SpatialGridModel Model;
+	Model.Initialize(4, 4);
+
+	const FInv_ItemId ItemId(7);
+	const FInv_ItemManifest Large = MakeItem({2, 2});
+	TestTrue(TEXT("Placed at 5"), Model.TryPlaceItem(ItemId, Large, {5, 0}));
+	TestTrue(TEXT("Any covered cell resolves to the item"), Model.GetItemId(10) == ItemId);
+	TestEqual(TEXT("Covered cells point at the anchor"), Model.GetUpperLeftIndex(10), 5);
+
+	TArray<FInv_GridPlacement> Placements;
+	Model.GetPlacements(ItemId, Placements);
+	if (!TestEqual(TEXT("One placement"), Placements.Num(), 1)) return false;
+	TestEqual(TEXT("Placement index"), Placements[0].Index, 5);
+
+	// 重叠、越界和不合法的堆叠数量都不能放下
+	TestFalse(TEXT("Overlapping placement rejected"), Model.TryPlaceItem(FInv_ItemId(8), Large, {6, 0}));
+	TestFalse(TEXT("Out of bounds placement rejected"), Model.TryPlaceItem(FInv_ItemId(8), Large, {3, 0}));
+	TestFalse(TEXT("Stack count on a non-stackable item rejected"),
+	          Model.TryPlaceItem(FInv_ItemId(8), MakeItem({1, 1}), {0, 2}));
+	TestFalse(TEXT("Item without an ID rejected"), Model.TryPlaceItem(FInv_ItemId(), Large, {0, 0}));
+
+	Model.ClearItem(5, {2, 2});
+	for (const int32 Index : {5, 6, 9, 10})
+	{
+		TestFalse(FString::Printf(TEXT("Cell %d cleared"), Index), Model.IsOccupied(Index));
+		TestFalse(FString::Printf(TEXT("Cell %d has no item"), Index), Model.GetItemId(Index).IsValid());
+	}
+
+	TestTrue(TEXT("Placed again after the clear"), Model.TryPlaceItem(ItemId, Large, {5, 0}));
+	Model.ClearPlacements(ItemId, Large);
+	TestEqual(TEXT("Empty grid after ClearPlacements"), Model.FindFreeAnchorForItem(Large), 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,12 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Types/Inv_ItemId.h"
+
+bool FInv_ItemId::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// 变长编码：每 7 位一个字节，刚分配的小 ID 只需要一个字节
+	Ar.SerializeIntPacked64(Value);
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
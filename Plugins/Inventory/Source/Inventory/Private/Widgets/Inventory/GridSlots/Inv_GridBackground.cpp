@@ -0,0 +1,113 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/Inventory/GridSlots/Inv_GridBackground.h"
+
+#include "Widgets/Inventory/GridSlots/SInv_GridBackground.h"
+
+TSharedRef<SWidget> UInv_GridBackground::RebuildWidget()
+{
+	MyGridBackground = SNew(SInv_GridBackground)
+		.Rows(Rows)
+		.Columns(Columns)
+		.TileSize(TileSize)
+		.OnCellClicked(FOnGridCellEvent::CreateUObject(this, &ThisClass::HandleCellClicked))
+		.OnCellHovered(FOnGridCellEvent::CreateUObject(this, &ThisClass::HandleCellHovered))
+		.OnCellUnhovered(FOnGridCellEvent::CreateUObject(this, &ThisClass::HandleCellUnhovered));
+
+	return MyGridBackground.ToSharedRef();
+}
+
+void UInv_GridBackground::SynchronizeProperties()
+{
+	Super::SynchronizeProperties();
+
+	if (!MyGridBackground.IsValid()) return;
+
+	for (const EInv_GridSlotState State : {
+		     EInv_GridSlotState::Unoccupied, EInv_GridSlotState::Occupied,
+		     EInv_GridSlotState::Selected, EInv_GridSlotState::GrayedOut
+	     })
+	{
+		MyGridBackground->SetBrush(State, &GetBrush(State));
+	}
+	MyGridBackground->SetCellStates(SlotStates);
+}
+
+void UInv_GridBackground::ReleaseSlateResources(bool bReleaseChildren)
+{
+	Super::ReleaseSlateResources(bReleaseChildren);
+
+	MyGridBackground.Reset();
+}
+
+void UInv_GridBackground::SetGridLayout(const int32 InRows, const int32 InColumns, const float InTileSize)
+{
+	Rows = InRows;
+	Columns = InColumns;
+	TileSize = InTileSize;
+	SlotStates.Init(EInv_GridSlotState::Unoccupied, FMath::Max(Rows * Columns, 0));
+
+	if (MyGridBackground.IsValid())
+	{
+		MyGridBackground->SetGridLayout(Rows, Columns, TileSize);
+	}
+}
+
+void UInv_GridBackground::SetBrushesFrom(const UInv_GridSlot* GridSlotStyle)
+{
+	if (!IsValid(GridSlotStyle)) return;
+
+	Brush_Unoccupied = GridSlotStyle->GetBrush(EInv_GridSlotState::Unoccupied);
+	Brush_Occupied = GridSlotStyle->GetBrush(EInv_GridSlotState::Occupied);
+	Brush_Selected = GridSlotStyle->GetBrush(EInv_GridSlotState::Selected);
+	Brush_GrayedOut = GridSlotStyle->GetBrush(EInv_GridSlotState::GrayedOut);
+
+	SynchronizeProperties();
+}
+
+void UInv_GridBackground::SetSlotState(const int32 Index, const EInv_GridSlotState State)
+{
+	if (!SlotStates.IsValidIndex(Index) || SlotStates[Index] == State) return;
+
+	SlotStates[Index] = State;
+	if (MyGridBackground.IsValid())
+	{
+		MyGridBackground->SetCellState(Index, State);
+	}
+}
+
+EInv_GridSlotState UInv_GridBackground::GetSlotState(const int32 Index) const
+{
+	return SlotStates.IsValidIndex(Index) ? SlotStates[Index] : EInv_GridSlotState::Unoccupied;
+}
+
+void UInv_GridBackground::HandleCellClicked(int32 CellIndex, const FPointerEvent& MouseEvent)
+{
+	GridSlotClicked.Broadcast(CellIndex, MouseEvent);
+}
+
+void UInv_GridBackground::HandleCellHovered(int32 CellIndex, const FPointerEvent& MouseEvent)
+{
+	GridSlotHovered.Broadcast(CellIndex, MouseEvent);
+}
+
+void UInv_GridBackground::HandleCellUnhovered(int32 CellIndex, const FPointerEvent& MouseEvent)
+{
+	GridSlotUnhovered.Broadcast(CellIndex, MouseEvent);
+}
+
+const FSlateBrush& UInv_GridBackground::GetBrush(const EInv_GridSlotState State) const
+{
+	switch (State)
+	{
+	case EInv_GridSlotState::Occupied:
+		return Brush_Occupied;
+	case EInv_GridSlotState::Selected:
+		return Brush_Selected;
+	case EInv_GridSlotState::GrayedOut:
+		return Brush_GrayedOut;
+	default:
+		return Brush_Unoccupied;
+	}
+}
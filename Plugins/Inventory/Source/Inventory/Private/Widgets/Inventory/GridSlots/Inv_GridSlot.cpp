@@ -2,7 +2,6 @@
 
 
 #include "Widgets/Inventory/GridSlots/Inv_GridSlot.h"
-#include "Items/Inv_InventoryItem.h"
 
 #include "Components/Image.h"
 
@@ -27,6 +26,21 @@ FReply UInv_GridSlot::NativeOnMouseButtonDown(const FGeometry& InGeometry, const
 	return Super::NativeOnMouseButtonDown(InGeometry, InMouseEvent);
 }
 
+const FSlateBrush& UInv_GridSlot::GetBrush(const EInv_GridSlotState State) const
+{
+	switch (State)
+	{
+	case EInv_GridSlotState::Occupied:
+		return Brush_Occupied;
+	case EInv_GridSlotState::Selected:
+		return Brush_Selected;
+	case EInv_GridSlotState::GrayedOut:
+		return Brush_GrayedOut;
+	default:
+		return Brush_Unoccupied;
+	}
+}
+
 void UInv_GridSlot::SetOccupiedTexture()
 {
 	GridSlotState = EInv_GridSlotState::Occupied;
@@ -50,8 +64,3 @@ void UInv_GridSlot::SetGrayedOutTexture()
 	GridSlotState = EInv_GridSlotState::GrayedOut;
 	Image_GridSlot->SetBrush(Brush_GrayedOut);
 }
-
-void UInv_GridSlot::SetInventoryItem(UInv_InventoryItem* Item)
-{
-	InventoryItem = Item;
-}
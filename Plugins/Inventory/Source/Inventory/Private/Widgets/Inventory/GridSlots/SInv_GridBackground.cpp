@@ -0,0 +1,148 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/Inventory/GridSlots/SInv_GridBackground.h"
+
+void SInv_GridBackground::Construct(const FArguments& InArgs)
+{
+	OnCellClicked = InArgs._OnCellClicked;
+	OnCellHovered = InArgs._OnCellHovered;
+	OnCellUnhovered = InArgs._OnCellUnhovered;
+
+	// 只在格子状态变化时显式失效，不需要 Tick，在全局失效模式下可以被完全缓存
+	SetCanTick(false);
+
+	SetGridLayout(InArgs._Rows, InArgs._Columns, InArgs._TileSize);
+}
+
+void SInv_GridBackground::SetGridLayout(const int32 InRows, const int32 InColumns, const float InTileSize)
+{
+	Rows = FMath::Max(InRows, 0);
+	Columns = FMath::Max(InColumns, 0);
+	TileSize = InTileSize;
+	CellStates.Init(EInv_GridSlotState::Unoccupied, Rows * Columns);
+	HoveredCellIndex = INDEX_NONE;
+
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SInv_GridBackground::SetBrush(const EInv_GridSlotState State, const FSlateBrush* Brush)
+{
+	Brushes[static_cast<int32>(State)] = Brush;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SInv_GridBackground::SetCellState(const int32 Index, const EInv_GridSlotState State)
+{
+	if (!CellStates.IsValidIndex(Index) || CellStates[Index] == State) return;
+
+	CellStates[Index] = State;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SInv_GridBackground::SetCellStates(const TArray<EInv_GridSlotState>& States)
+{
+	if (States.Num() != CellStates.Num()) return;
+
+	CellStates = States;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+int32 SInv_GridBackground::GetCellIndexAt(const FGeometry& Geometry, const FVector2D& ScreenPosition) const
+{
+	if (TileSize <= 0.f) return INDEX_NONE;
+
+	const FVector2D LocalPosition = Geometry.AbsoluteToLocal(ScreenPosition);
+	const int32 Column = FMath::FloorToInt32(LocalPosition.X / TileSize);
+	const int32 Row = FMath::FloorToInt32(LocalPosition.Y / TileSize);
+	if (Column < 0 || Column >= Columns || Row < 0 || Row >= Rows) return INDEX_NONE;
+
+	return Row * Columns + Column;
+}
+
+int32 SInv_GridBackground::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+                                   const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+                                   int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	if (TileSize <= 0.f || CellStates.IsEmpty()) return LayerId;
+
+	const ESlateDrawEffect DrawEffects = ShouldBeEnabled(bParentEnabled)
+		                                     ? ESlateDrawEffect::None
+		                                     : ESlateDrawEffect::DisabledEffect;
+	const FLinearColor WidgetTint = InWidgetStyle.GetColorAndOpacityTint();
+
+	// 只画裁剪区域内的行，网格放在 ScrollBox 里时大部分行都不需要画
+	const FVector2D CullTopLeft = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetTopLeft());
+	const FVector2D CullBottomRight = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetBottomRight());
+	const int32 FirstRow = FMath::Clamp(FMath::FloorToInt32(CullTopLeft.Y / TileSize), 0, Rows);
+	const int32 LastRow = FMath::Clamp(FMath::CeilToInt32(CullBottomRight.Y / TileSize), 0, Rows);
+
+	// 所有格子都画在同一层上，使用相同笔刷的格子会被渲染器合并成一个批次
+	const FVector2f CellSize(TileSize, TileSize);
+	for (int32 Row = FirstRow; Row < LastRow; ++Row)
+	{
+		for (int32 Column = 0; Column < Columns; ++Column)
+		{
+			const FSlateBrush* Brush = Brushes[static_cast<int32>(CellStates[Row * Columns + Column])];
+			if (!Brush || Brush->DrawAs == ESlateBrushDrawType::NoDrawType) continue;
+
+			const FVector2f CellPosition(Column * TileSize, Row * TileSize);
+			FSlateDrawElement::MakeBox(
+				OutDrawElements,
+				LayerId,
+				AllottedGeometry.ToPaintGeometry(CellSize, FSlateLayoutTransform(CellPosition)),
+				Brush,
+				DrawEffects,
+				WidgetTint * Brush->GetTint(InWidgetStyle));
+		}
+	}
+
+	return LayerId;
+}
+
+FReply SInv_GridBackground::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const int32 CellIndex = GetCellIndexAt(MyGeometry, MouseEvent.GetScreenSpacePosition());
+	if (CellIndex != INDEX_NONE)
+	{
+		OnCellClicked.ExecuteIfBound(CellIndex, MouseEvent);
+	}
+	return FReply::Unhandled();
+}
+
+FReply SInv_GridBackground::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const int32 CellIndex = GetCellIndexAt(MyGeometry, MouseEvent.GetScreenSpacePosition());
+	if (CellIndex != HoveredCellIndex)
+	{
+		const int32 PreviousCellIndex = HoveredCellIndex;
+		HoveredCellIndex = CellIndex;
+
+		if (PreviousCellIndex != INDEX_NONE)
+		{
+			OnCellUnhovered.ExecuteIfBound(PreviousCellIndex, MouseEvent);
+		}
+		if (CellIndex != INDEX_NONE)
+		{
+			OnCellHovered.ExecuteIfBound(CellIndex, MouseEvent);
+		}
+	}
+	return FReply::Unhandled();
+}
+
+void SInv_GridBackground::OnMouseLeave(const FPointerEvent& MouseEvent)
+{
+	SLeafWidget::OnMouseLeave(MouseEvent);
+
+	if (HoveredCellIndex != INDEX_NONE)
+	{
+		const int32 PreviousCellIndex = HoveredCellIndex;
+		HoveredCellIndex = INDEX_NONE;
+		OnCellUnhovered.ExecuteIfBound(PreviousCellIndex, MouseEvent);
+	}
+}
+
+FVector2D SInv_GridBackground::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	return FVector2D(Columns * TileSize, Rows * TileSize);
+}
@@ -0,0 +1,74 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "Widgets/Inventory/GridSlots/Inv_GridSlot.h"
+
+DECLARE_DELEGATE_TwoParams(FOnGridCellEvent, int32 /*CellIndex*/, const FPointerEvent& /*MouseEvent*/);
+
+/**
+ * 在一次 OnPaint 中画出整个网格背景的 Slate 控件。
+ * 每个格子只是状态数组中的一个元素，鼠标落在哪个格子上直接由坐标算出来，不再需要每格一个 Widget。
+ */
+class SInv_GridBackground : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SInv_GridBackground)
+			: _Rows(0)
+			  , _Columns(0)
+			  , _TileSize(0.f)
+		{
+		}
+
+		SLATE_ARGUMENT(int32, Rows)
+		SLATE_ARGUMENT(int32, Columns)
+		SLATE_ARGUMENT(float, TileSize)
+		SLATE_EVENT(FOnGridCellEvent, OnCellClicked)
+		SLATE_EVENT(FOnGridCellEvent, OnCellHovered)
+		SLATE_EVENT(FOnGridCellEvent, OnCellUnhovered)
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	void SetGridLayout(const int32 InRows, const int32 InColumns, const float InTileSize);
+
+	/** 每种状态使用的笔刷，笔刷由外部持有 */
+	void SetBrush(const EInv_GridSlotState State, const FSlateBrush* Brush);
+
+	void SetCellState(const int32 Index, const EInv_GridSlotState State);
+	void SetCellStates(const TArray<EInv_GridSlotState>& States);
+
+	/** 屏幕坐标落在哪个格子上，不在网格内时返回 INDEX_NONE */
+	int32 GetCellIndexAt(const FGeometry& Geometry, const FVector2D& ScreenPosition) const;
+
+	//~ Begin SWidget Interface
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect,
+	                      FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle,
+	                      bool bParentEnabled) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual void OnMouseLeave(const FPointerEvent& MouseEvent) override;
+	//~ End SWidget Interface
+
+protected:
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	static constexpr int32 NumStates = static_cast<int32>(EInv_GridSlotState::GrayedOut) + 1;
+
+	int32 Rows{0};
+	int32 Columns{0};
+	float TileSize{0.f};
+
+	TArray<EInv_GridSlotState> CellStates;
+	const FSlateBrush* Brushes[NumStates]{};
+
+	/** 鼠标当前所在的格子，用来把 MouseMove 转换成格子的进入/离开事件 */
+	int32 HoveredCellIndex{INDEX_NONE};
+
+	FOnGridCellEvent OnCellClicked;
+	FOnGridCellEvent OnCellHovered;
+	FOnGridCellEvent OnCellUnhovered;
+};
@@ -5,20 +5,32 @@
 
 #include "Components/Image.h"
 #include "Components/TextBlock.h"
-#include "Items/Inv_InventoryItem.h"
+#include "Widgets/Utils/Inv_IconSubsystem.h"
 
 void UInv_HoverItem::SetImageBrush(const FSlateBrush& Brush) const
 {
+	UInv_IconSubsystem::CancelImageIcon(this, Image_Icon);
 	Image_Icon->SetBrush(Brush);
 }
 
+void UInv_HoverItem::SetIcon(const FGameplayTag& ItemType, const TSoftObjectPtr<UTexture2D>& Icon,
+                             const FVector2D& ImageSize, const FSlateBrush& Placeholder) const
+{
+	UInv_IconSubsystem::SetImageIcon(this, Image_Icon, ItemType, Icon, ImageSize, Placeholder);
+}
+
 void UInv_HoverItem::UpdateStackCount(const int32 Count)
 {
 	StackCount = Count;
+
+	// 拖动中反复交换/填充堆叠时，数量没变就不去碰 TextBlock
+	if (Count == DisplayedStackCount) return;
+	DisplayedStackCount = Count;
+
 	if (Count > 0)
 	{
 		Text_StackCount->SetText(FText::AsNumber(Count));
-		Text_StackCount->SetVisibility(ESlateVisibility::Visible);
+		Text_StackCount->SetVisibility(ESlateVisibility::HitTestInvisible);
 	}
 	else
 	{
@@ -28,11 +40,7 @@ void UInv_HoverItem::UpdateStackCount(const int32 Count)
 
 FGameplayTag UInv_HoverItem::GetItemType() const
 {
-	if (InventoryItem.IsValid())
-	{
-		return InventoryItem.Get()->GetItemManifest().GetItemType();
-	}
-	return FGameplayTag();
+	return InventoryItem.GetItemManifest().GetItemType();
 }
 
 void UInv_HoverItem::SetIsStackable(bool bStacks)
@@ -41,15 +49,11 @@ void UInv_HoverItem::SetIsStackable(bool bStacks)
 	if (!bStacks)
 	{
 		Text_StackCount->SetVisibility(ESlateVisibility::Collapsed);
+		DisplayedStackCount = 0;
 	}
 }
 
-UInv_InventoryItem* UInv_HoverItem::GetInventoryItem() const
-{
-	return InventoryItem.Get();
-}
-
-void UInv_HoverItem::SetInventoryItem(UInv_InventoryItem* Item)
+void UInv_HoverItem::SetInventoryItem(const FInv_ItemHandle& Item)
 {
 	InventoryItem = Item;
 }
@@ -5,11 +5,12 @@
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
 #include "Blueprint/UserWidget.h"
+#include "Items/Inv_ItemHandle.h"
 #include "Inv_HoverItem.generated.h"
 
-class UInv_InventoryItem;
 class UTextBlock;
 class UImage;
+class UTexture2D;
 /**
  * HoverItem 是用户拖动背包里的道具时出现并跟随玩家鼠标的道具 Widget。
  */
@@ -20,6 +21,9 @@ class INVENTORY_API UInv_HoverItem : public UUserWidget
 
 public:
 	void SetImageBrush(const FSlateBrush& Brush) const;
+	/** 设置图标，图标还没加载时先显示 Placeholder */
+	void SetIcon(const FGameplayTag& ItemType, const TSoftObjectPtr<UTexture2D>& Icon,
+	             const FVector2D& ImageSize, const FSlateBrush& Placeholder) const;
 	void UpdateStackCount(const int32 Count);
 
 	FGameplayTag GetItemType() const;
@@ -30,8 +34,8 @@ public:
 	void SetPreviousGridIndex(int32 Index) { PreviousGridIndex = Index; }
 	FIntPoint GetGridDimensions() const { return GridDimensions; }
 	void SetGridDimensions(const FIntPoint& Dimensions) { GridDimensions = Dimensions; }
-	UInv_InventoryItem* GetInventoryItem() const;
-	void SetInventoryItem(UInv_InventoryItem* Item);
+	const FInv_ItemHandle& GetInventoryItem() const { return InventoryItem; }
+	void SetInventoryItem(const FInv_ItemHandle& Item);
 
 private:
 	UPROPERTY(meta=(BindWidget))
@@ -42,7 +46,10 @@ private:
 
 	int32 PreviousGridIndex;
 	FIntPoint GridDimensions;
-	TWeakObjectPtr<UInv_InventoryItem> InventoryItem;
+	FInv_ItemHandle InventoryItem;
 	bool bIsStackable{false};
 	int32 StackCount{0};
+
+	/** 当前显示的堆叠数量，INDEX_NONE 表示还没有显示过 */
+	int32 DisplayedStackCount{INDEX_NONE};
 };
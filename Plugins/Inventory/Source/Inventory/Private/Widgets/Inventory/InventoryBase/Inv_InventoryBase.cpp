@@ -3,7 +3,70 @@
 
 #include "Widgets/Inventory/InventoryBase/Inv_InventoryBase.h"
 
+#include "Inventory.h"
+#include "Debugging/SlateDebugging.h"
+
+static TAutoConsoleVariable<bool> CVarInventoryTrackInvalidation(
+	TEXT("Inventory.TrackInvalidation"),
+	false,
+	TEXT("Count the widgets inside the inventory menu that get invalidated each frame (see stat Inventory)."));
+
+void UInv_InventoryBase::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+#if WITH_SLATE_DEBUGGING
+	WidgetInvalidatedHandle = FSlateDebugging::WidgetInvalidateEvent.AddUObject(
+		this, &ThisClass::HandleWidgetInvalidated);
+#endif
+}
+
+void UInv_InventoryBase::NativeDestruct()
+{
+#if WITH_SLATE_DEBUGGING
+	FSlateDebugging::WidgetInvalidateEvent.Remove(WidgetInvalidatedHandle);
+#endif
+	WidgetInvalidatedHandle.Reset();
+
+	Super::NativeDestruct();
+}
+
+void UInv_InventoryBase::HandleWidgetInvalidated(const FSlateDebuggingInvalidateArgs& Args) const
+{
+#if WITH_SLATE_DEBUGGING
+	if (!CVarInventoryTrackInvalidation.GetValueOnGameThread() || !Args.WidgetInvalidated) return;
+
+	const SWidget* MenuWidget = GetCachedWidget().Get();
+	if (!MenuWidget) return;
+
+	// 只统计道具栏内部的 Widget
+	for (const SWidget* Widget = Args.WidgetInvalidated; Widget; Widget = Widget->GetParentWidget().Get())
+	{
+		if (Widget != MenuWidget) continue;
+
+		INC_DWORD_STAT(STAT_Inv_InvalidatedWidgets);
+		if (EnumHasAnyFlags(Args.InvalidateWidgetReason, EInvalidateWidgetReason::Layout))
+		{
+			INC_DWORD_STAT(STAT_Inv_LayoutInvalidations);
+		}
+		return;
+	}
+#endif
+}
+
 FInv_SlotAvailabilityResult UInv_InventoryBase::HasRoomForItem(UInv_ItemComponent* ItemComponent) const
 {
 	return FInv_SlotAvailabilityResult();
 }
+
+TArray<FInv_SlotAvailabilityResult> UInv_InventoryBase::HasRoomForItems(
+	const TArray<UInv_ItemComponent*>& ItemComponents) const
+{
+	TArray<FInv_SlotAvailabilityResult> Results;
+	Results.Reserve(ItemComponents.Num());
+	for (UInv_ItemComponent* ItemComponent : ItemComponents)
+	{
+		Results.Add(HasRoomForItem(ItemComponent));
+	}
+	return Results;
+}
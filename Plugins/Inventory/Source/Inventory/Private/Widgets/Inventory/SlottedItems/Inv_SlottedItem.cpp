@@ -2,9 +2,9 @@
 
 
 #include "Widgets/Inventory/SlottedItems/Inv_SlottedItem.h"
-#include "Inventory/Public/Items/Inv_InventoryItem.h"
 #include "Components/Image.h"
 #include "Components/TextBlock.h"
+#include "Widgets/Utils/Inv_IconSubsystem.h"
 
 FReply UInv_SlottedItem::NativeOnMouseButtonDown(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
 {
@@ -12,21 +12,33 @@ FReply UInv_SlottedItem::NativeOnMouseButtonDown(const FGeometry& InGeometry, co
 	return FReply::Handled();
 }
 
-void UInv_SlottedItem::SetInventoryItem(UInv_InventoryItem* InInventoryItem)
+void UInv_SlottedItem::SetInventoryItem(const FInv_ItemHandle& InInventoryItem)
 {
 	InventoryItem = InInventoryItem;
 }
 
 void UInv_SlottedItem::SetImageBrush(const FSlateBrush& Brush) const
 {
+	UInv_IconSubsystem::CancelImageIcon(this, Image_Icon);
 	Image_Icon->SetBrush(Brush);
 }
 
-void UInv_SlottedItem::UpdateStackCount(const int32 StackCount) const
+void UInv_SlottedItem::SetIcon(const FGameplayTag& ItemType, const TSoftObjectPtr<UTexture2D>& Icon,
+                               const FVector2D& ImageSize, const FSlateBrush& Placeholder) const
 {
+	UInv_IconSubsystem::SetImageIcon(this, Image_Icon, ItemType, Icon, ImageSize, Placeholder);
+}
+
+void UInv_SlottedItem::UpdateStackCount(const int32 StackCount)
+{
+	// 每次 SetText 都会生成新的 FText 并让文本重新布局，数量没变时什么都不做
+	if (StackCount == DisplayedStackCount) return;
+	DisplayedStackCount = StackCount;
+
 	if (StackCount > 0)
 	{
-		Text_StackCount->SetVisibility(ESlateVisibility::Visible);
+		// 数字不需要响应鼠标，点击由 SlottedItem 自己处理
+		Text_StackCount->SetVisibility(ESlateVisibility::HitTestInvisible);
 		Text_StackCount->SetText(FText::AsNumber(StackCount));
 	}
 	else
@@ -3,60 +3,129 @@
 
 #include "Widgets/Inventory/Spatial/Inv_InventoryGrid.h"
 
+#include "Inventory.h"
 #include "Blueprint/WidgetLayoutLibrary.h"
+#include "Blueprint/WidgetTree.h"
 #include "Components/CanvasPanel.h"
 #include "Components/CanvasPanelSlot.h"
 #include "InventoryManagement/Components/Inv_InventoryComponent.h"
 #include "InventoryManagement/Utils/Inv_InventoryStatics.h"
-#include "Items/Inv_InventoryItem.h"
 #include "Items/Components/Inv_ItemComponent.h"
 #include "Items/Fragments/Inv_FragmentTags.h"
 #include "Items/Fragments/Inv_ItemFragment.h"
+#include "Widgets/Inventory/GridSlots/Inv_GridBackground.h"
 #include "Widgets/Inventory/GridSlots/Inv_GridSlot.h"
 #include "Widgets/Utils/Inv_WidgetUtils.h"
 #include "Items/Manifest/Inv_ItemManifest.h"
 #include "Widgets/Inventory/HoverItem/Inv_HoverItem.h"
 #include "Widgets/Inventory/SlottedItems/Inv_SlottedItem.h"
 
+UInv_InventoryGrid::UInv_InventoryGrid(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	  , SlottedItemPool(*this)
+	  , HoverItemPool(*this)
+{
+	IconPlaceholderBrush = FSlateNoResource();
+}
+
+void UInv_InventoryGrid::ReleaseSlateResources(bool bReleaseChildren)
+{
+	Super::ReleaseSlateResources(bReleaseChildren);
+
+	SlottedItemPool.ReleaseAllSlateResources();
+	HoverItemPool.ReleaseAllSlateResources();
+}
+
 void UInv_InventoryGrid::NativeOnInitialized()
 {
 	Super::NativeOnInitialized();
 
-	ConstructGrid();
+	UInv_InventoryComponent* OwningInventory = UInv_InventoryStatics::GetInventoryComponent(GetOwningPlayer());
+	if (!ensureMsgf(OwningInventory, TEXT("Grid %s has no Inventory Component to read its size from."), *GetName()))
+	{
+		return;
+	}
 
-	InventoryComponent = UInv_InventoryStatics::GetInventoryComponent(GetOwningPlayer());
+	// 本地预测依赖与服务器相同的网格尺寸，所以尺寸只从 InventoryComponent 读取；没有配置的网格不初始化
+	const FIntPoint GridSize = OwningInventory->GetGridSize(ItemCategory);
+	if (!ensureMsgf(FInv_SpatialGridModel::IsValidSize(GridSize.Y, GridSize.X),
+	                TEXT("Inventory Component has no valid grid size for grid %s (got %dx%d)."),
+	                *GetName(), GridSize.X, GridSize.Y))
+	{
+		return;
+	}
+	Columns = GridSize.X;
+	Rows = GridSize.Y;
+
+	// 格子的显示等到第一次显示网格时再创建，见 EnsureGridConstructed
+	GridModel.Initialize(Rows, Columns);
+
+	InventoryComponent = OwningInventory;
 	InventoryComponent->OnItemAdded.AddDynamic(this, &ThisClass::AddItem);
+	InventoryComponent->OnItemRemoved.AddDynamic(this, &ThisClass::RemoveItem);
 	InventoryComponent->OnStackChange.AddDynamic(this, &ThisClass::AddStacks);
+	InventoryComponent->OnStackReconciled.AddDynamic(this, &ThisClass::ReconcileStacks);
+	InventoryComponent->OnItemChanged.AddDynamic(this, &ThisClass::OnItemChanged);
+}
+
+FReply UInv_InventoryGrid::NativeOnMouseMove(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
+{
+	UpdateMousePosition(InMouseEvent.GetScreenSpacePosition());
+
+	return Super::NativeOnMouseMove(InGeometry, InMouseEvent);
 }
 
-void UInv_InventoryGrid::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+void UInv_InventoryGrid::NativeOnMouseLeave(const FPointerEvent& InMouseEvent)
 {
-	Super::NativeTick(MyGeometry, InDeltaTime);
+	Super::NativeOnMouseLeave(InMouseEvent);
 
-	const FVector2D CanvasPosition = UInv_WidgetUtils::GetWidgetPosition(CanvasPanel);
-	const FVector2D CanvasSize = UInv_WidgetUtils::GetWidgetSize(CanvasPanel);
-	const FVector2D MousePosition = UWidgetLayoutLibrary::GetMousePositionOnViewport(GetOwningPlayer());
+	OnCursorExitedCanvas();
+}
+
+void UInv_InventoryGrid::UpdateMousePosition(const FVector2D& ScreenPosition)
+{
+	if (!bGridConstructed) return;
 
-	if (CursorExitedCanvas(CanvasPosition, CanvasSize, MousePosition))
+	// Canvas 的几何信息是 Slate 在布局时缓存下来的，这里只做一次坐标变换
+	const FGeometry& CanvasGeometry = CanvasPanel->GetCachedGeometry();
+	CanvasMousePosition = CanvasGeometry.AbsoluteToLocal(ScreenPosition);
+
+	if (!UInv_WidgetUtils::IsWithinBounds(FVector2D::ZeroVector, CanvasGeometry.GetLocalSize(), CanvasMousePosition))
 	{
+		OnCursorExitedCanvas();
 		return;
 	}
+	bMouseWithinCanvas = true;
+
+	// 没有拖动道具时不需要计算 TileParameters
+	if (!IsValid(HoverItem)) return;
+
+	UpdateTileParameters(CanvasMousePosition);
+}
 
-	UpdateTileParameters(CanvasPosition, MousePosition);
+void UInv_InventoryGrid::RefreshHoverHighlight()
+{
+	if (!IsValid(HoverItem)) return;
+
+	// 拖动的道具变了，即使鼠标还在同一格也要重新计算
+	UpdateTileParameters(CanvasMousePosition, true);
 }
 
-void UInv_InventoryGrid::UpdateTileParameters(const FVector2D& CanvasPosition, const FVector2D& MousePosition)
+void UInv_InventoryGrid::UpdateTileParameters(const FVector2D& InCanvasMousePosition, const bool bForceUpdate)
 {
 	// 如果鼠标不在 Canvas Panel 中就不处理
 	if (!bMouseWithinCanvas) return;
 
 	// 算出 TileParameters，包括鼠标在哪一格，鼠标在哪个 Index 上，鼠标在格子上的哪一象限
-	const FIntPoint HoveredTileCoordinates = CalculateHoveredCoordinates(CanvasPosition, MousePosition);
+	const FIntPoint HoveredTileCoordinates = CalculateHoveredCoordinates(InCanvasMousePosition);
 
 	LastTileParameters = TileParameters;
 	TileParameters.TileCoordinates = HoveredTileCoordinates;
 	TileParameters.TileIndex = UInv_WidgetUtils::GetIndexFromPosition(HoveredTileCoordinates, Columns);
-	TileParameters.TileQuadrant = CalculateTileQuadrant(CanvasPosition, MousePosition);
+	TileParameters.TileQuadrant = CalculateTileQuadrant(InCanvasMousePosition);
+
+	// 鼠标还在同一格的同一象限时高亮区域不会变，不需要做任何事
+	if (!bForceUpdate && TileParameters == LastTileParameters) return;
 
 	// 处理格子的高亮与否
 	OnTileParameterUpdated(TileParameters);
@@ -82,125 +151,95 @@ void UInv_InventoryGrid::OnTileParameterUpdated(const FInv_TileParameters& Param
 		HighLightSlots(ItemDropIndex, Dimensions);
 		return;
 	}
-	UnhighLightSlots(LastHighlightedIndex, LastHighlightedDimensions);
 
-	if (CurrentQueryResult.ValidItem.IsValid() && GridSlots.IsValidIndex(CurrentQueryResult.UpperLeftIndex))
+	if (CurrentQueryResult.ItemId.IsValid() && GridModel.IsValidIndex(CurrentQueryResult.UpperLeftIndex))
 	{
 		// 可以交换或合并道具
 		const FInv_GridFragment* GridFragment = GetFragment<FInv_GridFragment>(
-			CurrentQueryResult.ValidItem.Get(), FragmentTags::GridFragment);
-		if (!GridFragment) return;
-
-		ChangeHoverType(CurrentQueryResult.UpperLeftIndex, GridFragment->GetGridSize(), EInv_GridSlotState::GrayedOut);
+			GetItemHandle(CurrentQueryResult.ItemId), FragmentTags::GridFragment);
+		if (GridFragment)
+		{
+			ChangeHoverType(CurrentQueryResult.UpperLeftIndex, GridFragment->GetGridSize(),
+			                EInv_GridSlotState::GrayedOut);
+			return;
+		}
 	}
+	UnhighLightSlots();
 }
 
 FInv_SpaceQueryResult UInv_InventoryGrid::CheckHoverPosition(const FIntPoint& Position, const FIntPoint& Dimensions)
 {
-	FInv_SpaceQueryResult QueryResult;
-
-	// 在 Grid 范围内吗？
-	if (!IsInGridBounds(UInv_WidgetUtils::GetIndexFromPosition(Position, Columns), Dimensions)) return QueryResult;
-
-	QueryResult.bHasSpace = true;
-
-	// 这里有道具吗？若有物品，是否仅唯一单元格持有同一物品？
-	// - 因为正在拖动的道具可能会覆盖住一片区域，该区域可能有多个道具的锚点在
-	TSet<int32> OccupiedUpperLeftIndices;
-	UInv_InventoryStatics::ForEach2D(GridSlots, UInv_WidgetUtils::GetIndexFromPosition(Position, Columns), Dimensions,
-	                                 Columns, [&](const UInv_GridSlot* GridSlot)
-	                                 {
-		                                 if (GridSlot->GetInventoryItem().IsValid())
-		                                 {
-			                                 OccupiedUpperLeftIndices.Add(GridSlot->GetUpperLeftIndex());
-			                                 QueryResult.bHasSpace = false;
-		                                 }
-	                                 });
-
-	// 能和这个道具交换吗？
-	// 等于 0：完全空闲，直接返回 hasSpace = true。
-	// 等于 1：有且仅有一个物品覆盖区域，允许“交换”或“合并”：
-	//  从集合中取出唯一索引，读取该格子的物品指针，赋给 result.validItem。
-	//  同时将该索引写入 result.upperLeftIndex。
-	// 大于 1：多于一个物品来源，既不可交换也不可放置，保持 hasSpace = false。
-
-	if (OccupiedUpperLeftIndices.Num() == 1) // 只有一个道具在这个位置上 —— 可以交换或者合并
-	{
-		const int32 Index = *OccupiedUpperLeftIndices.CreateConstIterator();
-		QueryResult.ValidItem = GridSlots[Index]->GetInventoryItem();
-		QueryResult.UpperLeftIndex = GridSlots[Index]->GetUpperLeftIndex();
-	}
-
-	return QueryResult;
+	// 等于 0 个道具：完全空闲，hasSpace = true。
+	// 等于 1 个道具：有且仅有一个物品覆盖区域，允许“交换”或“合并”，结果中会带上该道具及其锚点。
+	// 大于 1 个道具：既不可交换也不可放置，hasSpace = false。
+	return GridModel.QuerySpace(Position, Dimensions);
 }
 
-bool UInv_InventoryGrid::CursorExitedCanvas(const FVector2D& BoundaryPos, const FVector2D& BoundarySize,
-                                            const FVector2D& Location)
+void UInv_InventoryGrid::OnCursorExitedCanvas()
 {
-	bLastMouseWithinCanvas = bMouseWithinCanvas;
-	bMouseWithinCanvas = UInv_WidgetUtils::IsWithinBounds(BoundaryPos, BoundarySize, Location);
-	if (!bMouseWithinCanvas && bLastMouseWithinCanvas)
-	{
-		UnhighLightSlots(LastHighlightedIndex, LastHighlightedDimensions);
-		return true;
-	}
-	return false;
+	if (!bMouseWithinCanvas) return;
+
+	bMouseWithinCanvas = false;
+	UnhighLightSlots();
 }
 
 void UInv_InventoryGrid::HighLightSlots(const int32 Index, const FIntPoint& Dimensions)
 {
 	if (!bMouseWithinCanvas) return;
 
-	UnhighLightSlots(LastHighlightedIndex, LastHighlightedDimensions);
+	SetHighlight(Index, Dimensions, EInv_GridSlotState::Occupied);
+}
 
-	UInv_InventoryStatics::ForEach2D(GridSlots, Index, Dimensions, Columns, [&](UInv_GridSlot* GridSlot)
-	{
-		GridSlot->SetOccupiedTexture();
-	});
-	LastHighlightedDimensions = Dimensions;
-	LastHighlightedIndex = Index;
+void UInv_InventoryGrid::UnhighLightSlots()
+{
+	SetHighlight(INDEX_NONE, FIntPoint(0, 0), EInv_GridSlotState::Unoccupied);
 }
 
-void UInv_InventoryGrid::UnhighLightSlots(const int32 Index, const FIntPoint& Dimensions)
+void UInv_InventoryGrid::SetHighlight(const int32 Index, const FIntPoint& Dimensions,
+                                      const EInv_GridSlotState GridSlotState)
 {
-	UInv_InventoryStatics::ForEach2D(GridSlots, Index, Dimensions, Columns, [&](UInv_GridSlot* GridSlot)
+	if (!bGridConstructed) return;
+
+	const bool bHasNewRegion = GridModel.IsValidIndex(Index);
+	const int32 NewColumn = bHasNewRegion ? Index % Columns : 0;
+	const int32 NewRow = bHasNewRegion ? Index / Columns : 0;
+	auto IsInNewRegion = [&](const int32 TileIndex)
 	{
-		if (GridSlot->IsAvailable())
-		{
-			GridSlot->SetUnoccupiedTexture();
-		}
-		else
+		if (!bHasNewRegion) return false;
+		const int32 Column = TileIndex % Columns;
+		const int32 Row = TileIndex / Columns;
+		return Column >= NewColumn && Column < NewColumn + Dimensions.X && Row >= NewRow && Row < NewRow + Dimensions.Y;
+	};
+
+	GridModel.ForEach2D(LastHighlightedIndex, LastHighlightedDimensions, [&](const int32 TileIndex)
+	{
+		if (!IsInNewRegion(TileIndex))
 		{
-			GridSlot->SetOccupiedTexture();
+			RestoreSlotState(TileIndex);
 		}
 	});
+
+	// 状态没变的格子在 GridBackground 中会被跳过，不会触发重绘
+	GridModel.ForEach2D(Index, Dimensions, [&](const int32 TileIndex)
+	{
+		GridBackground->SetSlotState(TileIndex, GridSlotState);
+	});
+
+	LastHighlightedIndex = bHasNewRegion ? Index : INDEX_NONE;
+	LastHighlightedDimensions = bHasNewRegion ? Dimensions : FIntPoint(0, 0);
+}
+
+void UInv_InventoryGrid::RestoreSlotState(const int32 TileIndex)
+{
+	GridBackground->SetSlotState(TileIndex, GridModel.IsOccupied(TileIndex)
+		                                        ? EInv_GridSlotState::Occupied
+		                                        : EInv_GridSlotState::Unoccupied);
 }
 
 void UInv_InventoryGrid::ChangeHoverType(const int32 Index, const FIntPoint& Dimensions,
                                          EInv_GridSlotState GridSlotState)
 {
-	UnhighLightSlots(LastHighlightedIndex, LastHighlightedDimensions);
-	UInv_InventoryStatics::ForEach2D(GridSlots, Index, Dimensions, Columns,
-	                                 [State = GridSlotState](UInv_GridSlot* GridSlot)
-	                                 {
-		                                 switch (State)
-		                                 {
-		                                 case EInv_GridSlotState::Occupied:
-			                                 GridSlot->SetOccupiedTexture();
-			                                 break;
-		                                 case EInv_GridSlotState::Unoccupied:
-			                                 GridSlot->SetUnoccupiedTexture();
-			                                 break;
-		                                 case EInv_GridSlotState::GrayedOut:
-			                                 GridSlot->SetGrayedOutTexture();
-			                                 break;
-		                                 case EInv_GridSlotState::Selected:
-			                                 GridSlot->SetSelectedTexture();
-			                                 break;
-		                                 }
-	                                 });
-	LastHighlightedIndex = Index;
-	LastHighlightedDimensions = Dimensions;
+	SetHighlight(Index, Dimensions, GridSlotState);
 }
 
 FIntPoint UInv_InventoryGrid::CalculateStartingCoordinate(const FIntPoint& Coordinate, const FIntPoint& Dimensions,
@@ -230,21 +269,19 @@ FIntPoint UInv_InventoryGrid::CalculateStartingCoordinate(const FIntPoint& Coord
 	return StartingCoord;
 }
 
-FIntPoint UInv_InventoryGrid::CalculateHoveredCoordinates(const FVector2D& CanvasPosition,
-                                                          const FVector2D& MousePosition) const
+FIntPoint UInv_InventoryGrid::CalculateHoveredCoordinates(const FVector2D& InCanvasMousePosition) const
 {
 	return FIntPoint{
-		FMath::FloorToInt32((MousePosition.X - CanvasPosition.X) / TileSize),
-		FMath::FloorToInt32((MousePosition.Y - CanvasPosition.Y) / TileSize),
+		FMath::FloorToInt32(InCanvasMousePosition.X / TileSize),
+		FMath::FloorToInt32(InCanvasMousePosition.Y / TileSize),
 	};
 }
 
-EInv_TileQuadrant UInv_InventoryGrid::CalculateTileQuadrant(const FVector2D& CanvasPosition,
-                                                            const FVector2D& MousePosition) const
+EInv_TileQuadrant UInv_InventoryGrid::CalculateTileQuadrant(const FVector2D& InCanvasMousePosition) const
 {
 	// 计算鼠标在格子中的位置
-	const float TileLocalX = FMath::Fmod(MousePosition.X - CanvasPosition.X, TileSize);
-	const float TileLocalY = FMath::Fmod(MousePosition.Y - CanvasPosition.Y, TileSize);
+	const float TileLocalX = FMath::Fmod(InCanvasMousePosition.X, TileSize);
+	const float TileLocalY = FMath::Fmod(InCanvasMousePosition.Y, TileSize);
 
 	// 计算鼠标在格子中的象限
 	const bool bIsTop = TileLocalY < TileSize / 2.f;
@@ -265,190 +302,14 @@ FInv_SlotAvailabilityResult UInv_InventoryGrid::HasRoomForItem(const UInv_ItemCo
 	return HasRoomForItem(ItemComponent->GetItemManifest());
 }
 
-FInv_SlotAvailabilityResult UInv_InventoryGrid::HasRoomForItem(const UInv_InventoryItem* Item)
+FInv_SlotAvailabilityResult UInv_InventoryGrid::HasRoomForItem(const FInv_ItemHandle& Item)
 {
-	return HasRoomForItem(Item->GetItemManifest());
+	return HasRoomForItem(Item.GetItemManifest());
 }
 
 FInv_SlotAvailabilityResult UInv_InventoryGrid::HasRoomForItem(const FInv_ItemManifest& Manifest)
 {
-	FInv_SlotAvailabilityResult Result;
-
-	// 确定物品是否可堆叠
-	const FInv_StackableFragment* StackableFragment = Manifest.GetFragmentOfType<FInv_StackableFragment>();
-	Result.bStackable = StackableFragment != nullptr;
-
-	// 确定需要添加的堆叠总数
-	const int32 MaxStackSize = StackableFragment ? StackableFragment->GetMaxStackSize() : 1;
-	int32 AmountToFill = StackableFragment ? StackableFragment->GetStackCount() : 1;
-
-	TSet<int32> CheckedIndices;
-	// 遍历物品栏中的每个格子：
-	// 这一层只看“锚点”(UpperLeft）是否可用，并不会对道具占据的网格片区做检查，只能算是一次外部的快速检查。
-	for (auto& GridSlot : GridSlots)
-	{
-		// 如果已无剩余堆叠需填充，则提前跳出循环
-		if (AmountToFill == 0) continue;
-
-		// 判断当前格子是否已被认领
-		if (IsIndexClaimed(CheckedIndices, GridSlot->GetTileIndex())) continue;
-
-		// 判断物品锚点是否在边界中
-		if (!IsInGridBounds(GridSlot->GetTileIndex(), GetItemDimensions(Manifest))) continue;
-
-		// 判断物品尺寸是否适合当前格子（不会超出网格边界）
-		// 这一层里面则是对每个道具占据的格子做判断
-		TSet<int32> TentativelyClaimed;
-		if (!HasRoomAtIndex(GridSlot, GetItemDimensions(Manifest), CheckedIndices, TentativelyClaimed,
-		                    Manifest.GetItemType(), MaxStackSize))
-		{
-			continue;
-		}
-
-		// 确认当前格子可以填多少数量的堆叠
-		const int32 AmountToFillInSlot = DetermineFillAmountForSlot(Result.bStackable, MaxStackSize, AmountToFill,
-		                                                            GridSlot);
-		if (AmountToFill == 0) continue;
-
-		CheckedIndices.Append(TentativelyClaimed);
-
-		// 把当前格子上的信息添加到 Result 中
-		Result.TotalRoomToFill += AmountToFillInSlot;
-		Result.SlotAvailabilities.Emplace(
-			FInv_SlotAvailability{
-				HasValidItem(GridSlot) ? GridSlot->GetUpperLeftIndex() : GridSlot->GetTileIndex(),
-				Result.bStackable ? AmountToFillInSlot : 0,
-				HasValidItem(GridSlot)
-			}
-		);
-
-		AmountToFill -= AmountToFillInSlot;
-
-		// 还有要添加的道具吗？没有就返回结果，有就继续找下一个格子的信息。
-		Result.Remainder = AmountToFill;
-
-		if (AmountToFill == 0) return Result;
-	}
-
-	return Result;
-}
-
-bool UInv_InventoryGrid::HasRoomAtIndex(const UInv_GridSlot* GridSlot, const FIntPoint& Dimensions,
-                                        const TSet<int32>& CheckedIndices, TSet<int32>& OutTentativelyClaimed,
-                                        const FGameplayTag& ItemType, const int32 StackMaxSize)
-{
-	bool bHasRoomAtIndex = true;
-
-	// 对每个合适位置执行2D范围检查（foreach 2D），检查其它的重要条件。
-	// SubGrid: 道具占据的每一个格子。这里是因为已经传入的用于获取索引的格子参数被命名为 GridSlot，所以我们把 ForEach2D 遍历的每一个格子叫做 SubGridSlot。
-	UInv_InventoryStatics::ForEach2D(
-		GridSlots, GridSlot->GetTileIndex(), Dimensions, Columns, [&](const UInv_GridSlot* SubGridSlot)
-		{
-			if (CheckSlotConstraints(GridSlot, SubGridSlot, CheckedIndices, OutTentativelyClaimed, ItemType,
-			                         StackMaxSize))
-			{
-				// 如果当前格子可以给道具使用，就把它加入到计划要占据的网格片当中
-				OutTentativelyClaimed.Add(SubGridSlot->GetTileIndex());
-			}
-			else
-			{
-				bHasRoomAtIndex = false;
-			}
-		});
-
-	return bHasRoomAtIndex;
-}
-
-bool UInv_InventoryGrid::CheckSlotConstraints(const UInv_GridSlot* GridSlot, const UInv_GridSlot* SubGridSlot,
-                                              const TSet<int32>& CheckedIndices, TSet<int32>& OutTentativelyClaimed,
-                                              const FGameplayTag& ItemType, const int32 StackMaxSize) const
-{
-	//---------------------------------------------------------//
-	// 这个函数进行的检查都是针对道具要占用的每一个网格进行的，
-	// 外部进行的检查和这里进行的检查具有不同的意义
-	//---------------------------------------------------------//
-
-	// 格子有被其它道具认领吗？
-	if (IsIndexClaimed(CheckedIndices, SubGridSlot->GetTileIndex())) return false;
-
-	// 格子上有其它道具吗？
-	if (!HasValidItem(SubGridSlot))
-	{
-		// 没有的话可以先认领
-		OutTentativelyClaimed.Add(SubGridSlot->GetTileIndex());
-		return true;
-	}
-
-	// 这是一个 Upper Left Slot 吗？
-	// 对于可堆叠的多格物品（比如 2×2 大小的药水），堆叠时只允许在该物品占用区域的上左方格（authoritative slot）进行：
-	// 如果在其它子格执行堆叠，会导致图标部分重叠，且实际上只是累加计数，不会生成新的 Widget。
-	// 因此，只有当子格正好是该已有物品的“上左”起始格时，才允许进行堆叠检查。
-	if (!IsUpperLeftSlot(GridSlot, SubGridSlot)) return false;
-
-	// 是可堆叠道具吗？
-	// 因为之前确保了当前格子上是有道具的，所以在不可堆叠的情况下要直接返回 false
-	const UInv_InventoryItem* SubItem = SubGridSlot->GetInventoryItem().Get();
-	if (!SubItem->IsStackable()) return false;
-
-	// 类型与我们要添加的道具的类型相同吗？
-	if (!DoesItemTypeMatch(SubItem, ItemType)) return false;
-
-	// 如果可堆叠，是否已经达到了堆叠上限？
-	if (GridSlot->GetStackCount() >= StackMaxSize) return false;
-
-	return true;
-}
-
-FIntPoint UInv_InventoryGrid::GetItemDimensions(const FInv_ItemManifest& Manifest) const
-{
-	const FInv_GridFragment* GridFragment = Manifest.GetFragmentOfType<FInv_GridFragment>();
-	return GridFragment ? GridFragment->GetGridSize() : FIntPoint(1, 1);
-}
-
-bool UInv_InventoryGrid::HasValidItem(const UInv_GridSlot* GridSlot) const
-{
-	return GridSlot->GetInventoryItem().IsValid();
-}
-
-bool UInv_InventoryGrid::IsUpperLeftSlot(const UInv_GridSlot* GridSlot, const UInv_GridSlot* SubGridSlot) const
-{
-	return SubGridSlot->GetUpperLeftIndex() == GridSlot->GetTileIndex();
-}
-
-bool UInv_InventoryGrid::DoesItemTypeMatch(const UInv_InventoryItem* SubItem, const FGameplayTag& ItemType) const
-{
-	return SubItem->GetItemManifest().GetItemType().MatchesTagExact(ItemType);
-}
-
-bool UInv_InventoryGrid::IsInGridBounds(const int32 StartIndex, const FIntPoint& ItemDimensions) const
-{
-	if (StartIndex < 0 || StartIndex >= GridSlots.Num())
-	{
-		return false;
-	}
-
-	const int32 EndColumn = (StartIndex % Columns) + ItemDimensions.X;
-	const int32 EndRow = (StartIndex / Columns) + ItemDimensions.Y;
-	return EndColumn <= Columns && EndRow <= Rows;
-}
-
-int32 UInv_InventoryGrid::DetermineFillAmountForSlot(const bool bStackable, const int32 MaxStackSize,
-                                                     const int32 AmountToFill, const UInv_GridSlot* GridSlot) const
-{
-	const int32 RoomInSlot = MaxStackSize - GetStackAmount(GridSlot);
-	return bStackable ? FMath::Min(AmountToFill, RoomInSlot) : 1;
-}
-
-int32 UInv_InventoryGrid::GetStackAmount(const UInv_GridSlot* GridSlot) const
-{
-	int32 CurrentStackCount = GridSlot->GetStackCount();
-	if (const int32 UpperLeftIndex = GridSlot->GetUpperLeftIndex(); UpperLeftIndex != INDEX_NONE)
-	{
-		UInv_GridSlot* UpperLeftGridSlot = GridSlots[UpperLeftIndex];
-		CurrentStackCount = UpperLeftGridSlot->GetStackCount();
-	}
-
-	return CurrentStackCount;
+	return GridModel.FindRoomForItem(Manifest);
 }
 
 bool UInv_InventoryGrid::IsRightClick(const FPointerEvent& MouseEvent) const
@@ -461,28 +322,30 @@ bool UInv_InventoryGrid::IsLeftClick(const FPointerEvent& MouseEvent) const
 	return MouseEvent.GetEffectingButton() == EKeys::LeftMouseButton;
 }
 
-void UInv_InventoryGrid::PickUp(UInv_InventoryItem* ClickedInventoryItem, const int32 GridIndex)
+void UInv_InventoryGrid::PickUp(const FInv_ItemHandle& ClickedInventoryItem, const int32 GridIndex)
 {
 	// Assign Hover Item
 	AssignHoverItem(ClickedInventoryItem, GridIndex, GridIndex);
 	// 从 Grid 移除点击的道具
 	RemoveItemFromGrid(ClickedInventoryItem, GridIndex);
+	SendItemPlacements({ClickedInventoryItem.GetItemId()});
+	RefreshHoverHighlight();
 }
 
-void UInv_InventoryGrid::AssignHoverItem(UInv_InventoryItem* InventoryItem, const int32 GridIndex,
+void UInv_InventoryGrid::AssignHoverItem(const FInv_ItemHandle& InventoryItem, const int32 GridIndex,
                                          const int32 PreviousGridIndex)
 {
 	AssignHoverItem(InventoryItem);
 
 	HoverItem->SetPreviousGridIndex(PreviousGridIndex);
-	HoverItem->UpdateStackCount(InventoryItem->IsStackable() ? GridSlots[GridIndex]->GetStackCount() : 0);
+	HoverItem->UpdateStackCount(InventoryItem.IsStackable() ? GridModel.GetStackCount(GridIndex) : 0);
 }
 
-void UInv_InventoryGrid::AssignHoverItem(UInv_InventoryItem* InventoryItem)
+void UInv_InventoryGrid::AssignHoverItem(const FInv_ItemHandle& InventoryItem)
 {
 	if (!IsValid(HoverItem))
 	{
-		HoverItem = CreateWidget<UInv_HoverItem>(GetOwningPlayer(), HoverItemClass);
+		HoverItem = AcquireHoverItem();
 	}
 
 	const FInv_GridFragment* GridFragment = GetFragment<FInv_GridFragment>(InventoryItem, FragmentTags::GridFragment);
@@ -493,73 +356,212 @@ void UInv_InventoryGrid::AssignHoverItem(UInv_InventoryItem* InventoryItem)
 
 	const FVector2D DrawSize = GetDrawSize(GridFragment);
 
-	FSlateBrush IconBrush;
-	IconBrush.SetResourceObject(ImageFragment->GetIcon());
-	IconBrush.DrawAs = ESlateBrushDrawType::Image;
-	IconBrush.ImageSize = DrawSize * UWidgetLayoutLibrary::GetViewportScale(this);
-
-	HoverItem->SetImageBrush(IconBrush);
+	HoverItem->SetIcon(InventoryItem.GetItemManifest().GetItemType(), ImageFragment->GetIcon(),
+	                   DrawSize * UWidgetLayoutLibrary::GetViewportScale(this), IconPlaceholderBrush);
 	HoverItem->SetGridDimensions(GridFragment->GetGridSize());
 	HoverItem->SetInventoryItem(InventoryItem);
-	HoverItem->SetIsStackable(InventoryItem->IsStackable());
+	HoverItem->SetIsStackable(InventoryItem.IsStackable());
 
 	GetOwningPlayer()->SetMouseCursorWidget(EMouseCursor::Default, HoverItem);
 }
 
-void UInv_InventoryGrid::RemoveItemFromGrid(UInv_InventoryItem* InventoryItem, const int32 GridIndex)
+void UInv_InventoryGrid::RemoveItemFromGrid(const FInv_ItemHandle& InventoryItem, const int32 GridIndex)
 {
 	// 拿到 Grid Fragment
 	const FInv_GridFragment* GridFragment = GetFragment<FInv_GridFragment>(InventoryItem, FragmentTags::GridFragment);
 	if (!GridFragment) return;
 
 	// 对每个格子取消占用
-	UInv_InventoryStatics::ForEach2D(GridSlots, GridIndex, GridFragment->GetGridSize(), Columns,
-	                                 [&](UInv_GridSlot* GridSlot)
-	                                 {
-		                                 GridSlot->SetInventoryItem(nullptr);
-		                                 GridSlot->SetUpperLeftIndex(INDEX_NONE);
-		                                 GridSlot->SetUnoccupiedTexture();
-		                                 GridSlot->SetAvailable(true);
-		                                 GridSlot->SetStackCount(0);
-	                                 });
+	GridModel.ClearItem(GridIndex, GridFragment->GetGridSize());
+	if (bGridConstructed)
+	{
+		GridModel.ForEach2D(GridIndex, GridFragment->GetGridSize(), [&](const int32 TileIndex)
+		{
+			GridBackground->SetSlotState(TileIndex, EInv_GridSlotState::Unoccupied);
+		});
+	}
 
 	// 从 Map 中移除
 	if (SlottedItems.Contains(GridIndex))
 	{
 		TObjectPtr<UInv_SlottedItem> FoundSlottedItem;
 		SlottedItems.RemoveAndCopyValue(GridIndex, FoundSlottedItem);
-		FoundSlottedItem->RemoveFromParent();
+		ReleaseSlottedItem(FoundSlottedItem);
 	}
 }
 
 void UInv_InventoryGrid::AddStacks(const FInv_SlotAvailabilityResult& Result)
 {
-	if (!MatchesCategory(Result.Item.Get())) return;
+	const FInv_ItemHandle Item = GetItemHandle(Result.ItemId);
+	if (!MatchesCategory(Item)) return;
 
 	for (const auto& SlotAvailability : Result.SlotAvailabilities)
 	{
 		if (SlotAvailability.bItemAtIndex)
 		{
-			const auto& GridSlot = GridSlots[SlotAvailability.Index];
-			const auto& SlottedItem = SlottedItems.FindChecked(SlotAvailability.Index);
-			SlottedItem->UpdateStackCount(GridSlot->GetStackCount() + SlotAvailability.AmountToFill);
-			GridSlot->SetStackCount(GridSlot->GetStackCount() + SlotAvailability.AmountToFill);
+			const int32 NewStackCount = GridModel.GetStackCount(SlotAvailability.Index) + SlotAvailability.AmountToFill;
+			GridModel.SetStackCount(SlotAvailability.Index, NewStackCount);
+			// 网格还没构建时没有 SlottedItem
+			if (const TObjectPtr<UInv_SlottedItem>* SlottedItem = SlottedItems.Find(SlotAvailability.Index))
+			{
+				(*SlottedItem)->UpdateStackCount(NewStackCount);
+			}
 		}
 		// 这个 else 是针对没有任何道具的 Index 的
 		else
 		{
-			AddItemAtIndex(Result.Item.Get(), SlotAvailability.Index, Result.bStackable, SlotAvailability.AmountToFill);
-			UpdateGridSlots(Result.Item.Get(), SlotAvailability.Index, Result.bStackable,
-			                SlotAvailability.AmountToFill);
+			AddItemAtIndex(Item, SlotAvailability.Index, Result.bStackable, SlotAvailability.AmountToFill);
+			UpdateGridSlots(Item, SlotAvailability.Index, Result.bStackable, SlotAvailability.AmountToFill);
+		}
+	}
+}
+
+void UInv_InventoryGrid::ReconcileStacks(const FInv_SlotAvailabilityResult& Predicted,
+                                         const FInv_SlotAvailabilityResult& Authoritative)
+{
+	// 复制下来的布局就是服务器的结果，直接按它重新摆放
+	SyncItemPlacements(GetItemHandle(Predicted.ItemId));
+	if (Authoritative.ItemId != Predicted.ItemId)
+	{
+		SyncItemPlacements(GetItemHandle(Authoritative.ItemId));
+	}
+}
+
+void UInv_InventoryGrid::RemoveItem(const FInv_ItemHandle& Item)
+{
+	if (!MatchesCategory(Item)) return;
+
+	// 正拖在手上的道具一起放弃
+	if (IsValid(HoverItem) && HoverItem->GetInventoryItem() == Item)
+	{
+		ClearHoverItem();
+	}
+
+	TArray<FInv_GridPlacement> LocalPlacements;
+	GridModel.GetPlacements(Item.GetItemId(), LocalPlacements);
+	for (const FInv_GridPlacement& Placement : LocalPlacements)
+	{
+		RemoveItemFromGrid(Item, Placement.Index);
+	}
+}
+
+void UInv_InventoryGrid::OnItemChanged(const FInv_ItemHandle& Item, EInv_ItemChangeFlags ChangeFlags)
+{
+	if (EnumHasAnyFlags(ChangeFlags, EInv_ItemChangeFlags::Placements))
+	{
+		SyncItemPlacements(Item);
+	}
+	if (EnumHasAnyFlags(ChangeFlags, EInv_ItemChangeFlags::Fragments))
+	{
+		RefreshItemImages(Item);
+	}
+}
+
+void UInv_InventoryGrid::SyncItemPlacements(const FInv_ItemHandle& Item)
+{
+	if (!MatchesCategory(Item) || !InventoryComponent.IsValid()) return;
+
+	// 正拖在手上的道具以本地为准，放下时会再同步给服务器
+	if (IsValid(HoverItem) && HoverItem->GetInventoryItem() == Item) return;
+
+	const TArray<FInv_GridPlacement>* Placements = InventoryComponent->FindItemPlacements(Item.GetItemId());
+	if (!Placements) return;
+
+	TArray<FInv_GridPlacement> LocalPlacements;
+	GridModel.GetPlacements(Item.GetItemId(), LocalPlacements);
+	if (LocalPlacements == *Placements) return;
+
+	// 移除不再存在的锚点，同一锚点只是堆叠数量变了的话只更新 SlottedItem
+	TArray<FInv_GridPlacement> PlacementsToAdd(*Placements);
+	for (const FInv_GridPlacement& Local : LocalPlacements)
+	{
+		const int32 Found = PlacementsToAdd.IndexOfByPredicate([&Local](const FInv_GridPlacement& Placement)
+		{
+			return Placement.Index == Local.Index;
+		});
+		if (Found == INDEX_NONE)
+		{
+			RemoveItemFromGrid(Item, Local.Index);
+			continue;
+		}
+
+		const int32 NewStackCount = PlacementsToAdd[Found].StackCount;
+		if (NewStackCount != Local.StackCount)
+		{
+			GridModel.SetStackCount(Local.Index, NewStackCount);
+			if (const TObjectPtr<UInv_SlottedItem>* SlottedItem = SlottedItems.Find(Local.Index))
+			{
+				(*SlottedItem)->UpdateStackCount(NewStackCount);
+			}
+		}
+		PlacementsToAdd.RemoveAtSwap(Found);
+	}
+
+	ApplyPlacements(Item, PlacementsToAdd);
+}
+
+void UInv_InventoryGrid::RefreshItemImages(const FInv_ItemHandle& Item)
+{
+	if (!MatchesCategory(Item)) return;
+
+	const FInv_GridFragment* GridFragment = GetFragment<FInv_GridFragment>(Item, FragmentTags::GridFragment);
+	const FInv_ImageFragment* ImageFragment = GetFragment<FInv_ImageFragment>(Item, FragmentTags::IconFragment);
+	if (!GridFragment || !ImageFragment) return;
+
+	TArray<FInv_GridPlacement> LocalPlacements;
+	GridModel.GetPlacements(Item.GetItemId(), LocalPlacements);
+	for (const FInv_GridPlacement& Placement : LocalPlacements)
+	{
+		if (const TObjectPtr<UInv_SlottedItem>* SlottedItem = SlottedItems.Find(Placement.Index))
+		{
+			SetSlottedItemImage(*SlottedItem, GridFragment, ImageFragment);
+		}
+	}
+}
+
+void UInv_InventoryGrid::ApplyPlacements(const FInv_ItemHandle& Item, const TArray<FInv_GridPlacement>& Placements)
+{
+	const bool bStackable = Item.IsStackable();
+	for (const FInv_GridPlacement& Placement : Placements)
+	{
+		if (!GridModel.IsValidIndex(Placement.Index)) continue;
+
+		AddItemAtIndex(Item, Placement.Index, bStackable, Placement.StackCount);
+		UpdateGridSlots(Item, Placement.Index, bStackable, Placement.StackCount);
+	}
+}
+
+void UInv_InventoryGrid::SendItemPlacements(const TArrayView<const FInv_ItemId> ItemIds)
+{
+	if (!InventoryComponent.IsValid()) return;
+
+	TArray<FInv_ItemPlacementUpdate> Updates;
+	for (const FInv_ItemId ItemId : ItemIds)
+	{
+		if (!ItemId.IsValid() || Updates.ContainsByPredicate([ItemId](const FInv_ItemPlacementUpdate& Update)
+		{
+			return Update.ItemId == ItemId;
+		}))
+		{
+			continue;
 		}
+
+		FInv_ItemPlacementUpdate& Update = Updates.AddDefaulted_GetRef();
+		Update.ItemId = ItemId;
+		GridModel.GetPlacements(ItemId, Update.Placements);
+	}
+
+	if (!Updates.IsEmpty())
+	{
+		InventoryComponent->Server_SetItemPlacements(Updates);
 	}
 }
 
 void UInv_InventoryGrid::OnSlottedItemClicked(int32 GridIndex, const FPointerEvent& MouseEvent)
 {
-	check(GridSlots.IsValidIndex(GridIndex));
+	check(GridModel.IsValidIndex(GridIndex));
 
-	UInv_InventoryItem* ClickedInventoryItem = GridSlots[GridIndex]->GetInventoryItem().Get();
+	const FInv_ItemHandle ClickedInventoryItem = GetItemHandle(GridModel.GetItemId(GridIndex));
 
 	// 在没有 HoverItem + 左键单击的情况下进入拖动状态
 	if (!IsValid(HoverItem) && IsLeftClick(MouseEvent))
@@ -568,11 +570,23 @@ void UInv_InventoryGrid::OnSlottedItemClicked(int32 GridIndex, const FPointerEve
 		return;
 	}
 
+	// 在没有 HoverItem + 右键单击的情况下，把这一格的一半堆叠拆分到空位，位置由服务器决定
+	if (!IsValid(HoverItem) && IsRightClick(MouseEvent))
+	{
+		const int32 ClickedStackCount = GridModel.GetStackCount(GridIndex);
+		if (ClickedInventoryItem.IsStackable() && ClickedStackCount > 1 && InventoryComponent.IsValid())
+		{
+			InventoryComponent->Server_SplitItemStack(ClickedInventoryItem.GetItemId(), GridIndex,
+			                                          ClickedStackCount / 2);
+		}
+		return;
+	}
+
 	// 有 HoverItem 并点击到了道具的情况下，两者是否类型相同，且可堆叠？
 	if (IsSameStackable(ClickedInventoryItem))
 	{
-		const int32 ClickedStackCount = GridSlots[GridIndex]->GetStackCount();
-		const FInv_StackableFragment* StackableFragment = ClickedInventoryItem->GetItemManifest().GetFragmentOfType<
+		const int32 ClickedStackCount = GridModel.GetStackCount(GridIndex);
+		const FInv_StackableFragment* StackableFragment = ClickedInventoryItem.GetItemManifest().GetFragmentOfType<
 			FInv_StackableFragment>();
 		const int32 MaxStackSize = StackableFragment->GetMaxStackSize();
 		const int32 RoomInClickedSlot = MaxStackSize - ClickedStackCount;
@@ -610,17 +624,27 @@ void UInv_InventoryGrid::OnSlottedItemClicked(int32 GridIndex, const FPointerEve
 	SwapWithHoverItem(ClickedInventoryItem, GridIndex);
 }
 
-void UInv_InventoryGrid::AddItem(UInv_InventoryItem* Item)
+void UInv_InventoryGrid::AddItem(const FInv_ItemHandle& Item)
 {
 	if (!MatchesCategory(Item)) return;
 
+	// 服务器已经算好了布局，直接按它摆放
+	const TArray<FInv_GridPlacement>* Placements = InventoryComponent.IsValid()
+		                                               ? InventoryComponent->FindItemPlacements(Item.GetItemId())
+		                                               : nullptr;
+	if (Placements && !Placements->IsEmpty())
+	{
+		ApplyPlacements(Item, *Placements);
+		return;
+	}
+
 	FInv_SlotAvailabilityResult Result = HasRoomForItem(Item);
 
 	// 创建一个 Widget 来显示道具 icon，并添加到正确的 grid 中。
 	AddItemToIndices(Result, Item);
 }
 
-void UInv_InventoryGrid::AddItemToIndices(const FInv_SlotAvailabilityResult& Result, UInv_InventoryItem* NewItem)
+void UInv_InventoryGrid::AddItemToIndices(const FInv_SlotAvailabilityResult& Result, const FInv_ItemHandle& NewItem)
 {
 	for (const auto& Availability : Result.SlotAvailabilities)
 	{
@@ -629,9 +653,12 @@ void UInv_InventoryGrid::AddItemToIndices(const FInv_SlotAvailabilityResult& Res
 	}
 }
 
-void UInv_InventoryGrid::AddItemAtIndex(UInv_InventoryItem* Item, const int32 Index, const bool bStackable,
+void UInv_InventoryGrid::AddItemAtIndex(const FInv_ItemHandle& Item, const int32 Index, const bool bStackable,
                                         const int32 StackAmount)
 {
+	// 网格还没构建时只需要更新 GridModel（由 UpdateGridSlots 完成），构建时会按它补上 SlottedItem
+	if (!bGridConstructed) return;
+
 	// 获取 Grid Fragment，以确定该物品占用多少格子
 	const FInv_GridFragment* GridFragment = GetFragment<FInv_GridFragment>(Item, FragmentTags::GridFragment);
 	// 获取 Image Fragment，以显示物品图标
@@ -650,23 +677,71 @@ void UInv_InventoryGrid::AddItemAtIndex(UInv_InventoryItem* Item, const int32 In
 	SlottedItems.Add(Index, SlottedItem);
 }
 
-UInv_SlottedItem* UInv_InventoryGrid::CreateSlottedItem(UInv_InventoryItem* Item, const bool bStackable,
+UInv_SlottedItem* UInv_InventoryGrid::CreateSlottedItem(const FInv_ItemHandle& Item, const bool bStackable,
                                                         const int32 StackAmount, const FInv_GridFragment* GridFragment,
                                                         const FInv_ImageFragment* ImageFragment,
                                                         const int32 Index)
 {
-	UInv_SlottedItem* SlottedItem = CreateWidget<UInv_SlottedItem>(GetOwningPlayer(), SlottedItemClass);
+	UInv_SlottedItem* SlottedItem = AcquireSlottedItem();
 	SlottedItem->SetInventoryItem(Item);
 	SetSlottedItemImage(SlottedItem, GridFragment, ImageFragment);
 	SlottedItem->SetGridIndex(Index);
 	SlottedItem->SetIsStackable(bStackable);
 	const int32 StackUpdateAmount = bStackable ? StackAmount : 0;
 	SlottedItem->UpdateStackCount(StackUpdateAmount);
-	SlottedItem->OnSlottedItemClicked.AddDynamic(this, &ThisClass::OnSlottedItemClicked);
+	// 从池中复用的 Widget 已经绑定过了
+	SlottedItem->OnSlottedItemClicked.AddUniqueDynamic(this, &ThisClass::OnSlottedItemClicked);
+
+	return SlottedItem;
+}
+
+UInv_SlottedItem* UInv_InventoryGrid::AcquireSlottedItem()
+{
+	UInv_SlottedItem* SlottedItem = SlottedItemPool.GetOrCreateInstance<UInv_SlottedItem>(SlottedItemClass);
+
+	const int32 NumActive = SlottedItemPool.GetActiveWidgets().Num();
+	if (NumActive > NumSlottedItemsCreated)
+	{
+		INC_DWORD_STAT_BY(STAT_Inv_SlottedItemsCreated, NumActive - NumSlottedItemsCreated);
+		NumSlottedItemsCreated = NumActive;
+	}
+	INC_DWORD_STAT(STAT_Inv_ActiveSlottedItems);
 
 	return SlottedItem;
 }
 
+void UInv_InventoryGrid::ReleaseSlottedItem(UInv_SlottedItem* SlottedItem)
+{
+	if (!IsValid(SlottedItem)) return;
+
+	SlottedItem->RemoveFromParent();
+	SlottedItem->SetInventoryItem(FInv_ItemHandle());
+	SlottedItemPool.Release(SlottedItem);
+	DEC_DWORD_STAT(STAT_Inv_ActiveSlottedItems);
+}
+
+UInv_HoverItem* UInv_InventoryGrid::AcquireHoverItem()
+{
+	UInv_HoverItem* NewHoverItem = HoverItemPool.GetOrCreateInstance<UInv_HoverItem>(HoverItemClass);
+
+	const int32 NumActive = HoverItemPool.GetActiveWidgets().Num();
+	if (NumActive > NumHoverItemsCreated)
+	{
+		INC_DWORD_STAT_BY(STAT_Inv_HoverItemsCreated, NumActive - NumHoverItemsCreated);
+		NumHoverItemsCreated = NumActive;
+	}
+
+	return NewHoverItem;
+}
+
+void UInv_InventoryGrid::ReleaseHoverItem(UInv_HoverItem* InHoverItem)
+{
+	if (!IsValid(InHoverItem)) return;
+
+	InHoverItem->RemoveFromParent();
+	HoverItemPool.Release(InHoverItem);
+}
+
 void UInv_InventoryGrid::AddSlottedItemToCanvas(const int32 Index, const FInv_GridFragment* GridFragment,
                                                 UInv_SlottedItem* SlottedItem) const
 {
@@ -678,35 +753,26 @@ void UInv_InventoryGrid::AddSlottedItemToCanvas(const int32 Index, const FInv_Gr
 	CanvasSlot->SetPosition(DrawPosWithPadding);
 }
 
-void UInv_InventoryGrid::UpdateGridSlots(UInv_InventoryItem* NewItem, const int32 Index, bool bStackableItem,
+void UInv_InventoryGrid::UpdateGridSlots(const FInv_ItemHandle& NewItem, const int32 Index, bool bStackableItem,
                                          const int32 StackAmount)
 {
-	check(GridSlots.IsValidIndex(Index));
-
-	if (bStackableItem)
-	{
-		GridSlots[Index]->SetStackCount(StackAmount);
-	}
+	check(GridModel.IsValidIndex(Index));
 
 	const FInv_GridFragment* GridFragment = GetFragment<FInv_GridFragment>(NewItem, FragmentTags::GridFragment);
 	if (!GridFragment) return;
 
 	const FIntPoint Dimensions = GridFragment->GetGridSize();
 
-	UInv_InventoryStatics::ForEach2D(GridSlots, Index, Dimensions, Columns, [&](UInv_GridSlot* GridSlot)
+	GridModel.PlaceItem(NewItem.GetItemId(), NewItem.GetItemManifest().GetItemType(), Index, Dimensions,
+	                    bStackableItem ? StackAmount : 0);
+	if (!bGridConstructed) return;
+
+	GridModel.ForEach2D(Index, Dimensions, [&](const int32 TileIndex)
 	{
-		GridSlot->SetInventoryItem(NewItem);
-		GridSlot->SetUpperLeftIndex(Index);
-		GridSlot->SetOccupiedTexture();
-		GridSlot->SetAvailable(false);
+		GridBackground->SetSlotState(TileIndex, EInv_GridSlotState::Occupied);
 	});
 }
 
-bool UInv_InventoryGrid::IsIndexClaimed(const TSet<int32>& Indices, const int32 Index) const
-{
-	return Indices.Contains(Index);
-}
-
 FVector2D UInv_InventoryGrid::GetDrawSize(const FInv_GridFragment* GridFragment) const
 {
 	const float IconTileWidth = TileSize - GridFragment->GetGridPadding() * 2;
@@ -717,40 +783,59 @@ void UInv_InventoryGrid::SetSlottedItemImage(const UInv_SlottedItem* SlottedItem
                                              const FInv_GridFragment* GridFragment,
                                              const FInv_ImageFragment* ImageFragment) const
 {
-	FSlateBrush Brush;
-	Brush.SetResourceObject(ImageFragment->GetIcon());
-	Brush.DrawAs = ESlateBrushDrawType::Image;
-	Brush.ImageSize = GetDrawSize(GridFragment);
-	SlottedItem->SetImageBrush(Brush);
+	const FGameplayTag ItemType = SlottedItem->GetInventoryItem().GetItemManifest().GetItemType();
+	SlottedItem->SetIcon(ItemType, ImageFragment->GetIcon(), GetDrawSize(GridFragment), IconPlaceholderBrush);
 }
 
 
-void UInv_InventoryGrid::ConstructGrid()
+void UInv_InventoryGrid::EnsureGridConstructed()
 {
-	GridSlots.Reserve(Rows * Columns);
+	// 没有初始化成功的网格（尺寸无效）不创建显示
+	if (bGridConstructed || GridModel.Num() == 0) return;
+
+	ConstructGrid();
+	bGridConstructed = true;
+	PopulateFromModel();
+}
 
-	for (int32 j = 0; j < Rows; ++j)
+void UInv_InventoryGrid::PopulateFromModel()
+{
+	GridModel.ForEachAnchor([this](const int32 Index)
 	{
-		for (int32 i = 0; i < Columns; ++i)
+		const FInv_ItemHandle Item = GetItemHandle(GridModel.GetItemId(Index));
+		if (!Item.IsValid()) return;
+
+		const FInv_GridFragment* GridFragment = GetFragment<FInv_GridFragment>(Item, FragmentTags::GridFragment);
+		if (!GridFragment) return;
+
+		const bool bStackable = Item.IsStackable();
+		AddItemAtIndex(Item, Index, bStackable, bStackable ? GridModel.GetStackCount(Index) : 0);
+		GridModel.ForEach2D(Index, GridFragment->GetGridSize(), [this](const int32 TileIndex)
 		{
-			UInv_GridSlot* GridSlot = CreateWidget<UInv_GridSlot>(this, GridSlotClass);
-			CanvasPanel->AddChild(GridSlot);
-
-			// 设置元素的信息
-			const FIntPoint TilePosition(i, j);
-			GridSlot->SetTileIndex(UInv_WidgetUtils::GetIndexFromPosition(TilePosition, Columns));
-
-			// 设置布局
-			UCanvasPanelSlot* GridCPS = UWidgetLayoutLibrary::SlotAsCanvasSlot(GridSlot);
-			GridCPS->SetSize(FVector2D(TileSize));
-			GridCPS->SetPosition(TilePosition * TileSize);
-
-			GridSlots.Add(GridSlot);
-			GridSlot->GridSlotClicked.AddDynamic(this, &ThisClass::OnGridSlotClicked);
-			GridSlot->GridSlotHovered.AddDynamic(this, &ThisClass::OnGridSlotHovered);
-			GridSlot->GridSlotUnhovered.AddDynamic(this, &ThisClass::OnGridSlotUnhovered);
-		}
+			GridBackground->SetSlotState(TileIndex, EInv_GridSlotState::Occupied);
+		});
+	});
+}
+
+void UInv_InventoryGrid::ConstructGrid()
+{
+	// 整个网格只有一个背景控件，格子的状态与点击/悬停的格子 Index 都由它按坐标计算
+	GridBackground = WidgetTree->ConstructWidget<UInv_GridBackground>(UInv_GridBackground::StaticClass());
+	GridBackground->SetGridLayout(Rows, Columns, TileSize);
+	if (GridSlotClass)
+	{
+		GridBackground->SetBrushesFrom(GridSlotClass.GetDefaultObject());
 	}
+
+	// 先加入 Canvas，保证背景画在所有 SlottedItem 之下
+	CanvasPanel->AddChild(GridBackground);
+	UCanvasPanelSlot* GridCPS = UWidgetLayoutLibrary::SlotAsCanvasSlot(GridBackground);
+	GridCPS->SetSize(FVector2D(Columns, Rows) * TileSize);
+	GridCPS->SetPosition(FVector2D::ZeroVector);
+
+	GridBackground->GridSlotClicked.AddDynamic(this, &ThisClass::OnGridSlotClicked);
+	GridBackground->GridSlotHovered.AddDynamic(this, &ThisClass::OnGridSlotHovered);
+	GridBackground->GridSlotUnhovered.AddDynamic(this, &ThisClass::OnGridSlotUnhovered);
 }
 
 void UInv_InventoryGrid::OnGridSlotClicked(int32 GridIndex, const FPointerEvent& MouseEvent)
@@ -758,18 +843,17 @@ void UInv_InventoryGrid::OnGridSlotClicked(int32 GridIndex, const FPointerEvent&
 	// 只处理正在拖动道具时的放置
 	if (!IsValid(HoverItem)) return;
 
-	if (!GridSlots.IsValidIndex(ItemDropIndex)) return;
+	if (!GridModel.IsValidIndex(ItemDropIndex)) return;
 
 	// 如果道具悬停的区域中有道具，则捡起该道具
-	if (CurrentQueryResult.ValidItem.IsValid() && GridSlots.IsValidIndex(CurrentQueryResult.UpperLeftIndex))
+	if (CurrentQueryResult.ItemId.IsValid() && GridModel.IsValidIndex(CurrentQueryResult.UpperLeftIndex))
 	{
 		OnSlottedItemClicked(CurrentQueryResult.UpperLeftIndex, MouseEvent);
 		return;
 	}
 
 	// 如果当前格子没有道具，则放置 HoverItem
-	auto GridSlot = GridSlots[GridIndex];
-	if (!GridSlot->GetInventoryItem().IsValid())
+	if (!GridModel.IsOccupied(GridIndex))
 	{
 		PutDownOnIndex(ItemDropIndex);
 	}
@@ -777,21 +861,23 @@ void UInv_InventoryGrid::OnGridSlotClicked(int32 GridIndex, const FPointerEvent&
 
 void UInv_InventoryGrid::PutDownOnIndex(const int32 Index)
 {
-	AddItemAtIndex(HoverItem->GetInventoryItem(), Index, HoverItem->IsStackable(), HoverItem->GetStackCount());
-	UpdateGridSlots(HoverItem->GetInventoryItem(), Index, HoverItem->IsStackable(), HoverItem->GetStackCount());
+	const FInv_ItemHandle Item = HoverItem->GetInventoryItem();
+	AddItemAtIndex(Item, Index, HoverItem->IsStackable(), HoverItem->GetStackCount());
+	UpdateGridSlots(Item, Index, HoverItem->IsStackable(), HoverItem->GetStackCount());
 	ClearHoverItem();
+	SendItemPlacements({Item.GetItemId()});
 }
 
 void UInv_InventoryGrid::ClearHoverItem()
 {
 	if (!IsValid(HoverItem)) return;
-	HoverItem->SetInventoryItem(nullptr);
+	HoverItem->SetInventoryItem(FInv_ItemHandle());
 	HoverItem->SetIsStackable(false);
 	HoverItem->SetPreviousGridIndex(INDEX_NONE);
 	HoverItem->UpdateStackCount(0);
 	HoverItem->SetImageBrush(FSlateNoResource());
 
-	HoverItem->RemoveFromParent();
+	ReleaseHoverItem(HoverItem);
 	HoverItem = nullptr;
 
 	// 显示鼠标指针
@@ -818,19 +904,19 @@ UUserWidget* UInv_InventoryGrid::GetHiddenCursorWidget()
 	return HiddenCursorWidget;
 }
 
-bool UInv_InventoryGrid::IsSameStackable(const UInv_InventoryItem* ClickedInventoryItem) const
+bool UInv_InventoryGrid::IsSameStackable(const FInv_ItemHandle& ClickedInventoryItem) const
 {
 	const bool bIsSameItem = ClickedInventoryItem == HoverItem->GetInventoryItem();
-	const bool bIsStackable = ClickedInventoryItem->IsStackable();
+	const bool bIsStackable = ClickedInventoryItem.IsStackable();
 	return bIsSameItem && bIsStackable && HoverItem->GetItemType().MatchesTagExact(
-		ClickedInventoryItem->GetItemManifest().GetItemType());
+		ClickedInventoryItem.GetItemManifest().GetItemType());
 }
 
-void UInv_InventoryGrid::SwapWithHoverItem(UInv_InventoryItem* ClickedInventoryItem, const int32 GridIndex)
+void UInv_InventoryGrid::SwapWithHoverItem(const FInv_ItemHandle& ClickedInventoryItem, const int32 GridIndex)
 {
 	if (!IsValid(HoverItem)) return;
 
-	UInv_InventoryItem* TempInventoryItem = HoverItem->GetInventoryItem();
+	const FInv_ItemHandle TempInventoryItem = HoverItem->GetInventoryItem();
 	const int32 TempStackCount = HoverItem->GetStackCount();
 	const bool bTempIsStackable = HoverItem->IsStackable();
 
@@ -839,6 +925,8 @@ void UInv_InventoryGrid::SwapWithHoverItem(UInv_InventoryItem* ClickedInventoryI
 	RemoveItemFromGrid(ClickedInventoryItem, GridIndex);
 	AddItemAtIndex(TempInventoryItem, ItemDropIndex /* 在鼠标当前位置放下道具 */, bTempIsStackable, TempStackCount);
 	UpdateGridSlots(TempInventoryItem, ItemDropIndex, bTempIsStackable, TempStackCount);
+	SendItemPlacements({ClickedInventoryItem.GetItemId(), TempInventoryItem.GetItemId()});
+	RefreshHoverHighlight();
 }
 
 bool UInv_InventoryGrid::ShouldSwapStackCounts(const int32 RoomInClickedSlot, const int32 HoveredStackCount,
@@ -850,13 +938,13 @@ bool UInv_InventoryGrid::ShouldSwapStackCounts(const int32 RoomInClickedSlot, co
 void UInv_InventoryGrid::SwapStackCounts(const int32 ClickedStackCount, const int32 HoveredStackCount,
                                          const int32 Index)
 {
-	UInv_GridSlot* GridSlot = GridSlots[Index];
-	GridSlot->SetStackCount(HoveredStackCount);
+	GridModel.SetStackCount(Index, HoveredStackCount);
 
 	UInv_SlottedItem* ClickedSlottedItem = SlottedItems.FindChecked(Index);
 	ClickedSlottedItem->UpdateStackCount(HoveredStackCount);
 
 	HoverItem->UpdateStackCount(ClickedStackCount);
+	SendItemPlacements({GridModel.GetItemId(Index)});
 }
 
 bool UInv_InventoryGrid::ShouldConsumeHoverItemStacks(const int32 HoveredStackCount,
@@ -870,13 +958,14 @@ void UInv_InventoryGrid::ConsumeHoverItemStacks(const int32 ClickedStackCount, c
 {
 	const int32 NewClickedStackCount = ClickedStackCount + HoveredStackCount;
 
-	GridSlots[Index]->SetStackCount(NewClickedStackCount);
+	GridModel.SetStackCount(Index, NewClickedStackCount);
 	SlottedItems.FindChecked(Index)->UpdateStackCount(NewClickedStackCount);
 
 	ClearHoverItem();
+	SendItemPlacements({GridModel.GetItemId(Index)});
 
-	const FInv_GridFragment* GridFragment = GridSlots[Index]->GetInventoryItem()->GetItemManifest().GetFragmentOfType<
-		FInv_GridFragment>();
+	const FInv_GridFragment* GridFragment = GetItemHandle(GridModel.GetItemId(Index)).GetItemManifest().
+		GetFragmentOfType<FInv_GridFragment>();
 	const FIntPoint Dimensions = GridFragment ? GridFragment->GetGridSize() : FIntPoint(1, 1);
 	HighLightSlots(Index, Dimensions);
 }
@@ -888,15 +977,15 @@ bool UInv_InventoryGrid::ShouldFillInStackCount(const int32 RoomInClickedSlot, c
 
 void UInv_InventoryGrid::FillInStack(const int32 FillAmount, const int32 Remainder, const int32 Index)
 {
-	UInv_GridSlot* GridSlot = GridSlots[Index];
-	const int32 NewStackCount = GridSlot->GetStackCount() + FillAmount;
+	const int32 NewStackCount = GridModel.GetStackCount(Index) + FillAmount;
 
-	GridSlot->SetStackCount(NewStackCount);
+	GridModel.SetStackCount(Index, NewStackCount);
 
 	UInv_SlottedItem* ClickedSlottedItem = SlottedItems.FindChecked(Index);
 	ClickedSlottedItem->UpdateStackCount(NewStackCount);
 
 	HoverItem->UpdateStackCount(Remainder);
+	SendItemPlacements({GridModel.GetItemId(Index)});
 }
 
 void UInv_InventoryGrid::ShowCursor()
@@ -916,10 +1005,9 @@ void UInv_InventoryGrid::OnGridSlotHovered(int32 GridIndex, const FPointerEvent&
 	// 如果正在拖动道具则不处理悬停事件
 	if (IsValid(HoverItem)) return;
 
-	UInv_GridSlot* GridSlot = GridSlots[GridIndex];
-	if (GridSlot->IsAvailable())
+	if (!GridModel.IsOccupied(GridIndex))
 	{
-		GridSlot->SetOccupiedTexture();
+		GridBackground->SetSlotState(GridIndex, EInv_GridSlotState::Occupied);
 	}
 }
 
@@ -928,14 +1016,20 @@ void UInv_InventoryGrid::OnGridSlotUnhovered(int32 GridIndex, const FPointerEven
 	// 如果正在拖动道具则不处理悬停事件
 	if (IsValid(HoverItem)) return;
 
-	UInv_GridSlot* GridSlot = GridSlots[GridIndex];
-	if (GridSlot->IsAvailable())
+	if (!GridModel.IsOccupied(GridIndex))
 	{
-		GridSlot->SetUnoccupiedTexture();
+		GridBackground->SetSlotState(GridIndex, EInv_GridSlotState::Unoccupied);
 	}
 }
 
-bool UInv_InventoryGrid::MatchesCategory(const UInv_InventoryItem* Item) const
+bool UInv_InventoryGrid::MatchesCategory(const FInv_ItemHandle& Item) const
+{
+	const FInv_InventoryEntry* Entry = Item.FindEntry();
+	if (!Entry) return false;
+	return Entry->GetItemManifest().GetItemCategory() == ItemCategory;
+}
+
+FInv_ItemHandle UInv_InventoryGrid::GetItemHandle(const FInv_ItemId ItemId) const
 {
-	return Item->GetItemManifest().GetItemCategory() == ItemCategory;
+	return FInv_ItemHandle(InventoryComponent.Get(), ItemId);
 }
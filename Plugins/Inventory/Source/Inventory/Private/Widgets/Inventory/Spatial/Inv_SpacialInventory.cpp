@@ -4,15 +4,25 @@
 #include "Widgets/Inventory/Spatial/Inv_SpacialInventory.h"
 
 #include "Inventory.h"
+#include "Blueprint/WidgetTree.h"
 #include "Components/Button.h"
+#include "Components/InvalidationBox.h"
 #include "Components/WidgetSwitcher.h"
 #include "InventoryManagement/Utils/Inv_InventoryStatics.h"
+#include "Items/Components/Inv_ItemComponent.h"
 #include "Widgets/Inventory/Spatial/Inv_InventoryGrid.h"
 
 void UInv_SpacialInventory::NativeOnInitialized()
 {
 	Super::NativeOnInitialized();
 
+	if (bCacheGrids)
+	{
+		WrapInInvalidationBox(Grid_Equippables);
+		WrapInInvalidationBox(Grid_Consumables);
+		WrapInInvalidationBox(Grid_Craftables);
+	}
+
 	Button_Equippables->OnClicked.AddDynamic(this, &ThisClass::ShowEquippables);
 	Button_Consumables->OnClicked.AddDynamic(this, &ThisClass::ShowConsumables);
 	Button_Craftables->OnClicked.AddDynamic(this, &ThisClass::ShowCraftables);
@@ -22,17 +32,59 @@ void UInv_SpacialInventory::NativeOnInitialized()
 
 FInv_SlotAvailabilityResult UInv_SpacialInventory::HasRoomForItem(UInv_ItemComponent* ItemComponent) const
 {
-	switch (UInv_InventoryStatics::GetItemCategoryFromItemComp(ItemComponent))
+	UInv_InventoryGrid* Grid = GetGridForCategory(UInv_InventoryStatics::GetItemCategoryFromItemComp(ItemComponent));
+	if (!IsValid(Grid))
+	{
+		UE_LOG(LogInventory, Error, TEXT("ItemComponent doesn't have a valid Item Category."))
+		return FInv_SlotAvailabilityResult();
+	}
+	return Grid->HasRoomForItem(ItemComponent);
+}
+
+TArray<FInv_SlotAvailabilityResult> UInv_SpacialInventory::HasRoomForItems(
+	const TArray<UInv_ItemComponent*>& ItemComponents) const
+{
+	// 在网格模型的副本上依次规划，每个道具认领的格子都会写进副本，后面的道具就不会和它抢同一个位置
+	TMap<EInv_ItemCategory, FInv_SpatialGridModel> ScratchModels;
+
+	TArray<FInv_SlotAvailabilityResult> Results;
+	Results.Reserve(ItemComponents.Num());
+	for (UInv_ItemComponent* ItemComponent : ItemComponents)
+	{
+		const EInv_ItemCategory Category = UInv_InventoryStatics::GetItemCategoryFromItemComp(ItemComponent);
+		const UInv_InventoryGrid* Grid = GetGridForCategory(Category);
+		if (!IsValid(Grid))
+		{
+			UE_LOG(LogInventory, Error, TEXT("ItemComponent doesn't have a valid Item Category."))
+			Results.AddDefaulted();
+			continue;
+		}
+
+		FInv_SpatialGridModel* Model = ScratchModels.Find(Category);
+		if (!Model)
+		{
+			Model = &ScratchModels.Add(Category, Grid->GetGridModel());
+		}
+
+		const FInv_ItemManifest& Manifest = ItemComponent->GetItemManifest();
+		const FInv_SlotAvailabilityResult& Result = Results.Add_GetRef(Model->FindRoomForItem(Manifest));
+		Model->ReserveRoom(Result, Manifest);
+	}
+	return Results;
+}
+
+UInv_InventoryGrid* UInv_SpacialInventory::GetGridForCategory(const EInv_ItemCategory Category) const
+{
+	switch (Category)
 	{
 	case EInv_ItemCategory::Equippable:
-		return Grid_Equippables->HasRoomForItem(ItemComponent);
+		return Grid_Equippables;
 	case EInv_ItemCategory::Consumable:
-		return Grid_Consumables->HasRoomForItem(ItemComponent);
+		return Grid_Consumables;
 	case EInv_ItemCategory::Craftable:
-		return Grid_Craftables->HasRoomForItem(ItemComponent);
+		return Grid_Craftables;
 	default:
-		UE_LOG(LogInventory, Error, TEXT("ItemComponent doesn't have a valid Item Category."))
-		return FInv_SlotAvailabilityResult();
+		return nullptr;
 	}
 }
 
@@ -55,9 +107,34 @@ void UInv_SpacialInventory::SetActiveGrid(UInv_InventoryGrid* Grid, UButton* But
 {
 	if (ActiveGrid.IsValid()) ActiveGrid->HideCursor();
 	ActiveGrid = Grid;
-	if (ActiveGrid.IsValid()) ActiveGrid->ShowCursor();
+	if (ActiveGrid.IsValid())
+	{
+		ActiveGrid->EnsureGridConstructed();
+		ActiveGrid->ShowCursor();
+	}
 	DisableButton(Button);
-	Switcher->SetActiveWidget(Grid);
+	Switcher->SetActiveWidget(GetSwitcherChild(Grid));
+}
+
+void UInv_SpacialInventory::WrapInInvalidationBox(UInv_InventoryGrid* Grid)
+{
+	if (!IsValid(Grid) || Grid->GetParent() != Switcher) return;
+
+	// 沿用网格原来的 Switcher Slot，再把网格放进 InvalidationBox
+	UInvalidationBox* InvalidationBox = WidgetTree->ConstructWidget<UInvalidationBox>();
+	InvalidationBox->SetCanCache(true);
+	Switcher->ReplaceChildAt(Switcher->GetChildIndex(Grid), InvalidationBox);
+	InvalidationBox->SetContent(Grid);
+}
+
+UWidget* UInv_SpacialInventory::GetSwitcherChild(UInv_InventoryGrid* Grid) const
+{
+	UWidget* Child = Grid;
+	while (IsValid(Child) && Child->GetParent() && Child->GetParent() != Switcher)
+	{
+		Child = Child->GetParent();
+	}
+	return Child;
 }
 
 void UInv_SpacialInventory::DisableButton(UButton* Button)
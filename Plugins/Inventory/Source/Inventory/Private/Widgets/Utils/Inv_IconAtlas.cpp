@@ -0,0 +1,14 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/Utils/Inv_IconAtlas.h"
+
+#if WITH_EDITOR
+void UInv_IconAtlas::SetAtlasData(TArray<TSoftObjectPtr<UTexture2D>>&& InPages,
+                                  TMap<FGameplayTag, FInv_IconAtlasRegion>&& InRegions)
+{
+	Pages = MoveTemp(InPages);
+	Regions = MoveTemp(InRegions);
+	MarkPackageDirty();
+}
+#endif
@@ -0,0 +1,165 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/Utils/Inv_IconSubsystem.h"
+
+#include "Components/Image.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/Texture2D.h"
+#include "Widgets/Utils/Inv_IconAtlas.h"
+
+void UInv_IconSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LoadedIcons.Empty(FMath::Max(MaxCachedIcons, 1));
+
+	// 图集本身只有区域数据，图集页仍然按需异步加载
+	if (!IconAtlas.IsNull())
+	{
+		LoadedIconAtlas = IconAtlas.LoadSynchronous();
+	}
+}
+
+void UInv_IconSubsystem::Deinitialize()
+{
+	for (const TPair<FSoftObjectPath, TSharedPtr<FStreamableHandle>>& Loading : LoadingIcons)
+	{
+		if (Loading.Value.IsValid())
+		{
+			Loading.Value->CancelHandle();
+		}
+	}
+	LoadingIcons.Empty();
+	PendingImages.Empty();
+	LoadedIcons.Empty();
+
+	Super::Deinitialize();
+}
+
+UInv_IconSubsystem* UInv_IconSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = GEngine
+		                      ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull)
+		                      : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UInv_IconSubsystem>() : nullptr;
+}
+
+void UInv_IconSubsystem::SetImageIcon(const UObject* WorldContextObject, UImage* Image, const FGameplayTag& ItemType,
+                                      const TSoftObjectPtr<UTexture2D>& Icon, const FVector2D& ImageSize,
+                                      const FSlateBrush& Placeholder)
+{
+	if (!IsValid(Image)) return;
+
+	UInv_IconSubsystem* IconSubsystem = Get(WorldContextObject);
+	if (!IconSubsystem)
+	{
+		// 没有 GameInstance（比如编辑器预览）时直接同步加载
+		ApplyIcon(Image, Icon.LoadSynchronous(), ImageSize, FBox2f(ForceInit));
+		return;
+	}
+
+	const UInv_IconAtlas* Atlas = IconSubsystem->LoadedIconAtlas;
+	const FInv_IconAtlasRegion* Region = Atlas ? Atlas->FindRegion(ItemType) : nullptr;
+	if (Region && Atlas->IsValidPage(Region->PageIndex))
+	{
+		const FBox2f UVRegion(FVector2f(Region->UVMin), FVector2f(Region->UVMax));
+		IconSubsystem->RequestImageIcon(Image, Atlas->GetPage(Region->PageIndex), UVRegion, ImageSize, Placeholder);
+		return;
+	}
+
+	IconSubsystem->RequestImageIcon(Image, Icon, FBox2f(ForceInit), ImageSize, Placeholder);
+}
+
+void UInv_IconSubsystem::CancelImageIcon(const UObject* WorldContextObject, UImage* Image)
+{
+	if (UInv_IconSubsystem* IconSubsystem = Get(WorldContextObject))
+	{
+		IconSubsystem->PendingImages.Remove(Image);
+	}
+}
+
+void UInv_IconSubsystem::RequestImageIcon(UImage* Image, const TSoftObjectPtr<UTexture2D>& Icon,
+                                          const FBox2f& UVRegion, const FVector2D& ImageSize,
+                                          const FSlateBrush& Placeholder)
+{
+	const FSoftObjectPath IconPath = Icon.ToSoftObjectPath();
+
+	if (UTexture2D* LoadedIcon = Icon.Get())
+	{
+		PendingImages.Remove(Image);
+		LoadedIcons.FindAndTouch(IconPath);
+		ApplyIcon(Image, LoadedIcon, ImageSize, UVRegion);
+		return;
+	}
+
+	FSlateBrush PlaceholderBrush = Placeholder;
+	PlaceholderBrush.ImageSize = ImageSize;
+	Image->SetBrush(PlaceholderBrush);
+
+	if (IconPath.IsNull())
+	{
+		PendingImages.Remove(Image);
+		return;
+	}
+
+	PendingImages.Add(Image, FPendingImage{IconPath, ImageSize, UVRegion});
+	if (LoadingIcons.Contains(IconPath)) return;
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		IconPath, FStreamableDelegate::CreateUObject(this, &ThisClass::OnIconLoaded, IconPath));
+	if (!Handle.IsValid()) return;
+
+	// 已经在内存中的资源可能在 RequestAsyncLoad 里就完成了回调
+	if (Handle->HasLoadCompleted())
+	{
+		LoadedIcons.Add(IconPath, Handle);
+	}
+	else
+	{
+		LoadingIcons.Add(IconPath, Handle);
+	}
+}
+
+void UInv_IconSubsystem::OnIconLoaded(FSoftObjectPath IconPath)
+{
+	TSharedPtr<FStreamableHandle> Handle;
+	if (LoadingIcons.RemoveAndCopyValue(IconPath, Handle) && Handle.IsValid())
+	{
+		LoadedIcons.Add(IconPath, Handle);
+	}
+
+	UTexture2D* LoadedIcon = Cast<UTexture2D>(IconPath.ResolveObject());
+	for (auto It = PendingImages.CreateIterator(); It; ++It)
+	{
+		UImage* Image = It->Key.Get();
+		if (!Image)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		if (It->Value.IconPath != IconPath) continue;
+
+		ApplyIcon(Image, LoadedIcon, It->Value.ImageSize, It->Value.UVRegion);
+		It.RemoveCurrent();
+	}
+}
+
+void UInv_IconSubsystem::ApplyIcon(UImage* Image, UTexture2D* Icon, const FVector2D& ImageSize,
+                                   const FBox2f& UVRegion)
+{
+	if (!IsValid(Icon)) return;
+
+	FSlateBrush Brush;
+	Brush.SetResourceObject(Icon);
+	Brush.DrawAs = ESlateBrushDrawType::Image;
+	Brush.ImageSize = ImageSize;
+	if (UVRegion.bIsValid)
+	{
+		Brush.SetUVRegion(UVRegion);
+	}
+	Image->SetBrush(Brush);
+}
@@ -0,0 +1,144 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Inv_PickupSubsystem.generated.h"
+
+class AInv_PlayerController;
+class UInv_ItemComponent;
+
+struct FInv_PickupCandidate
+{
+	UInv_ItemComponent* ItemComponent{nullptr};
+
+	/** Pickup 可碰撞部分包围盒的中心，视锥判断和遮挡检测都以它为准 */
+	FVector TargetLocation{FVector::ZeroVector};
+
+	/** 与视线方向夹角的余弦，越大越靠近视线中心 */
+	float ViewDot{0.f};
+	float Distance{0.f};
+
+	/** 综合角度与距离的排序分数，越小越优先 */
+	float Score{0.f};
+};
+
+/**
+ * 场景中所有 Pickup（带 UInv_ItemComponent 的 Actor）的空间索引。
+ * Pickup 按水平位置放进固定大小的格子，PlayerController 按视锥只查询附近的几个格子，
+ * 不再每帧对准星做射线检测，物理检测只用于确认最佳候选有没有被遮挡。
+ *
+ * 同时负责调度本地玩家的查找：按 ScanRate 的频率查找，每帧最多查找 MaxScansPerFrame 次，
+ * 多个本地玩家（分屏）轮流错开到不同帧；背包打开时，或者视点和视锥覆盖的格子里的 Pickup 都没有变化时跳过。
+ */
+UCLASS(Config=Game)
+class INVENTORY_API UInv_PickupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	static UInv_PickupSubsystem* Get(const UObject* WorldContextObject);
+
+	void RegisterPickup(UInv_ItemComponent* ItemComponent);
+	void UnregisterPickup(UInv_ItemComponent* ItemComponent);
+
+	/** Pickup 移动后调用，只有跨越格子时才会更新索引 */
+	void UpdatePickup(UInv_ItemComponent* ItemComponent);
+
+	/** 本地 PlayerController 注册后由本系统调度它的 TraceForItem */
+	void RegisterScanner(AInv_PlayerController* Controller);
+	void UnregisterScanner(AInv_PlayerController* Controller);
+
+	/**
+	 * 查找视锥内的 Pickup，按离视线中心的角度和离视点的距离综合排序，最优先的在前
+	 * @param ConeHalfAngle 视锥半角（度）
+	 */
+	void FindPickupsInView(const FVector& ViewLocation, const FVector& ViewDirection, float MaxDistance,
+	                       float ConeHalfAngle, TArray<FInv_PickupCandidate>& OutCandidates) const;
+
+	/** Pickup 可碰撞部分包围盒的中心，没有可碰撞的部分时使用 Actor 的位置 */
+	static FVector GetTargetLocation(const AActor* Pickup);
+
+private:
+	struct FIndexedPickup
+	{
+		TWeakObjectPtr<UInv_ItemComponent> ItemComponent;
+
+		/** 注册或移动时缓存的 GetTargetLocation，查询时不需要再遍历 Actor 的组件 */
+		FVector TargetLocation{FVector::ZeroVector};
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** 格子里的 Pickup 注册、注销或移动时调用，给格子分配一个新的版本号 */
+	void TouchCell(const FIntPoint& Cell);
+
+	/** 格子边长 */
+	UPROPERTY(Config)
+	float CellSize{500.f};
+
+	/** 每个玩家每秒查找几次，0 表示每帧都查找 */
+	UPROPERTY(Config)
+	float ScanRate{10.f};
+
+	/** 排序时距离相对于角度的权重：角度按视锥半角、距离按最远距离归一化后相加 */
+	UPROPERTY(Config)
+	float DistanceWeight{0.5f};
+
+	/** 每帧最多查找几次，多出来的玩家顺延到下一帧 */
+	UPROPERTY(Config)
+	int32 MaxScansPerFrame{1};
+
+	/** 视点移动和转动都小于这两个阈值，并且上次查询覆盖的格子里 Pickup 没有变化时跳过查找 */
+	UPROPERTY(Config)
+	float MinViewLocationDelta{1.f};
+
+	UPROPERTY(Config)
+	float MinViewRotationDelta{0.5f};
+
+	struct FScanner
+	{
+		TWeakObjectPtr<AInv_PlayerController> Controller;
+		double NextScanTime{0.0};
+		FVector LastViewLocation{FVector::ZeroVector};
+		FRotator LastViewRotation{FRotator::ZeroRotator};
+
+		/** 上次查询覆盖的格子范围（向外多扩一格，视点的微小变化不会超出它），以及当时这些格子的版本号 */
+		FIntRect LastCells;
+		TArray<uint32> LastCellVersions;
+
+		bool bHasScanned{false};
+	};
+
+	/** 记下 Scanner 这次查询覆盖的格子的版本号 */
+	void SnapshotCellVersions(FScanner& Scanner, const FIntRect& QueriedCells) const;
+
+	/** Scanner 上次查询覆盖的格子里是否有 Pickup 发生了变化 */
+	bool HaveCellsChanged(const FScanner& Scanner) const;
+
+	TArray<FScanner> Scanners;
+
+	/** 下一帧从哪个玩家开始轮询 */
+	int32 NextScanner{0};
+
+	/**
+	 * 每个格子的版本号，格子里的 Pickup 注册、注销或移动时更新。
+	 * 每个 Scanner 只比较自己视锥覆盖的格子，场景另一头移动的物理 Pickup 不会打断其他玩家的跳过判断。
+	 * 没有记录的格子版本号为 0；格子清空后记录仍然保留，否则之后的比较会把“清空”误认为“没有变化”。
+	 */
+	TMap<FIntPoint, uint32> CellVersions;
+	uint32 LastCellVersion{0};
+
+	/** 最近一次 FindPickupsInView 覆盖的格子范围，Tick 在 TraceForItem 之后读取 */
+	mutable FIntRect LastQueriedCells;
+
+	TMap<FIntPoint, TArray<FIndexedPickup>> Cells;
+
+	/** 每个 Pickup 当前所在的格子 */
+	TMap<TWeakObjectPtr<UInv_ItemComponent>, FIntPoint> PickupCells;
+};
@@ -3,9 +3,27 @@
 #pragma once
 
 #include "Modules/ModuleManager.h"
+#include "Stats/Stats.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogInventory, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("Inventory"), STATGROUP_Inventory, STATCAT_Advanced);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Active Slotted Items"), STAT_Inv_ActiveSlottedItems, STATGROUP_Inventory, INVENTORY_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Slotted Items Created"), STAT_Inv_SlottedItemsCreated, STATGROUP_Inventory, INVENTORY_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Hover Items Created"), STAT_Inv_HoverItemsCreated, STATGROUP_Inventory, INVENTORY_API);
+
+// 每帧清零，只有打开 Inventory.TrackInvalidation 时才会统计
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Invalidated Widgets"), STAT_Inv_InvalidatedWidgets, STATGROUP_Inventory, INVENTORY_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Layout Invalidations"), STAT_Inv_LayoutInvalidations, STATGROUP_Inventory, INVENTORY_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pickup Scans"), STAT_Inv_PickupScans, STATGROUP_Inventory, INVENTORY_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pickup Scans Skipped"), STAT_Inv_PickupScansSkipped, STATGROUP_Inventory, INVENTORY_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Occlusion Traces"), STAT_Inv_OcclusionTraces, STATGROUP_Inventory, INVENTORY_API);
+
+// 每帧清零，FInv_ItemManifest 的拷贝构造/拷贝赋值次数，移动不计入
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Manifest Copies"), STAT_Inv_ManifestCopies, STATGROUP_Inventory, INVENTORY_API);
+
 class FInventoryModule : public IModuleInterface
 {
 public:
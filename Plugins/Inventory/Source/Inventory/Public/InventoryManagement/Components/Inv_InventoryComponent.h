@@ -5,18 +5,89 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "InventoryManagement/FastArray/Inv_FastArray.h"
+#include "InventoryManagement/Spatial/Inv_SpatialGridModel.h"
 #include "Inv_InventoryComponent.generated.h"
 
 class UInv_ItemComponent;
 class UInv_InventoryBase;
-class UInv_InventoryItem;
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInventoryItemChange, UInv_InventoryItem*, Item);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FInventoryItemChange, const FInv_ItemHandle&, Item);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FInventoryItemChanged, const FInv_ItemHandle&, Item,
+                                             EInv_ItemChangeFlags, ChangeFlags);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FNoRoomInInventory);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FStackChange, const FInv_SlotAvailabilityResult&, Result);
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FStackReconcile, const FInv_SlotAvailabilityResult&, Predicted,
+                                             const FInv_SlotAvailabilityResult&, Authoritative);
+
+/**
+ * 道具栏复制给哪些连接
+ */
+UENUM(BlueprintType)
+enum class EInv_InventoryReplicationPolicy : uint8
+{
+	/** 只复制给拥有者 */
+	OwnerOnly,
+	/** 拥有者，以及通过 AddInventoryObserver 订阅的玩家（查看队友的道具栏、观战） */
+	OwnerAndObservers
+};
+
+/**
+ * 客户端发给服务器的道具添加请求，只说明要捡哪个道具，放置由服务器自己计算
+ */
+USTRUCT()
+struct FInv_ItemAddRequest
+{
+	GENERATED_BODY()
+
+	/** 待添加的物品组件 */
+	UPROPERTY()
+	TObjectPtr<UInv_ItemComponent> ItemComponent;
+
+	/** 客户端预测的编号，服务器在确认中原样带回 */
+	UPROPERTY()
+	int32 PredictionKey{0};
+};
+
+/**
+ * 服务器对一次添加请求的确认，带着服务器计算出的权威放置结果
+ */
+USTRUCT()
+struct FInv_ItemAddAck
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 PredictionKey{0};
+
+	/** 服务器是否接受了本次添加 */
+	UPROPERTY()
+	bool bAccepted{false};
+
+	/** 服务器的放置结果；只有堆叠到已有道具时才会带上 ItemId，新道具会通过 FastArray 复制过来 */
+	UPROPERTY()
+	FInv_SlotAvailabilityResult Result;
+};
+
+/**
+ * 客户端拖放道具后，请求服务器更新某个道具的布局
+ */
+USTRUCT()
+struct FInv_ItemPlacementUpdate
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FInv_ItemId ItemId;
+
+	/** 道具在网格中的全部锚点；为空表示道具正被拖在手上 */
+	UPROPERTY()
+	TArray<FInv_GridPlacement> Placements;
+};
+
 /**
  * InventoryComponent负责管理物品列表，并通过FastArraySerializer（快速数组序列化器）管理网络复制。
  */
@@ -29,9 +100,46 @@ public:
 	UInv_InventoryComponent();
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
+	/**
+	 * 拾取道具：本地先预测堆叠结果并立即更新 UI，再请求服务器计算权威的放置结果
+	 */
 	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Inventory")
 	void TryAddItem(UInv_ItemComponent* ItemComponent);
 
+	/**
+	 * 一次拾取多个道具（比如搜刮整个箱子），所有道具的放置在一次规划中完成，只发送一个 RPC
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Inventory")
+	void TryAddItems(const TArray<UInv_ItemComponent*>& ItemComponents);
+
+	/**
+	 * 从道具栏丢弃道具，服务器会在拥有者面前生成 DropActorClass
+	 * @param StackCount 可堆叠道具要丢弃的数量，不大于 0 或不小于总数时丢弃整个道具
+	 */
+	UFUNCTION(BlueprintCallable, Category="Inventory")
+	void DropItem(const FInv_ItemHandle& Item, const int32 StackCount);
+
+	/**
+	 * 让 Observer 也收到这个道具栏，只在 ReplicationPolicy 为 OwnerAndObservers 时有效，
+	 * 并且要求拥有道具栏的 Actor 不是只与拥有者相关
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Inventory")
+	void AddInventoryObserver(APlayerController* Observer);
+
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category="Inventory")
+	void RemoveInventoryObserver(APlayerController* Observer);
+
+	/** 按 ID 查找道具的条目，道具不在道具栏中时返回 nullptr */
+	const FInv_InventoryEntry* FindItemEntry(const FInv_ItemId ItemId) const { return InventoryList.FindEntry(ItemId); }
+
+	/** 复制下来的道具布局，道具不在道具栏中时返回 nullptr */
+	const TArray<FInv_GridPlacement>* FindItemPlacements(const FInv_ItemId ItemId) const;
+
+	EInv_ItemStorageMode GetItemStorageMode() const { return ItemStorageMode; }
+
+	/** 服务器端某个分类网格的尺寸（X 为列数，Y 为行数） */
+	FIntPoint GetGridSize(const EInv_ItemCategory Category) const;
+
 	//--------------------------------
 	// RPC 属性解释
 	// Server：指定该函数在服务器上执行。客户端调用时，RPC 请求会从客户端发送到服务器，并在服务器端运行对应逻辑。
@@ -39,23 +147,44 @@ public:
 	//-------------------------------
 
 	/**
-	 * 新增物品到库存（不存在时）
-	 * @param ItemComponent 待添加的物品组件
-	 * @param StackCount 本次添加的物品数量。
+	 * 批量添加物品。服务器用自己的网格模型按顺序计算放置，不信任客户端的计算结果
+	 * @param Requests 每个物品组件的添加请求
 	 */
 	UFUNCTION(Server, Reliable)
-	void Server_AddNewItem(UInv_ItemComponent* ItemComponent, int32 StackCount);
+	void Server_AddItems(const TArray<FInv_ItemAddRequest>& Requests);
 
 	/**
-	 * 增加已有物品堆叠数量（存在时）
-	 * @param ItemComponent 待添加的物品组件
-	 * @param StackCount 本次添加的物品数量
-	 * @param Remainder （仅限堆叠情况）未能放入库存的剩余物品数量，用于决定是否保留或销毁剩余的拾取物。
+	 * 服务器把权威的放置结果发回给拥有者客户端，客户端据此确认或修正自己的预测
+	 * @param Acks 与请求一一对应的确认
+	 */
+	UFUNCTION(Client, Reliable)
+	void Client_AddItemsAck(const TArray<FInv_ItemAddAck>& Acks);
+
+	/**
+	 * 拖放道具之后同步布局。服务器验证所有更新都合法（不越界、不重叠、堆叠数量在范围内）才会整体接受，
+	 * 否则让客户端回到服务器的布局
+	 * @param Updates 受影响的道具及其新布局
+	 */
+	UFUNCTION(Server, Reliable)
+	void Server_SetItemPlacements(const TArray<FInv_ItemPlacementUpdate>& Updates);
+
+	/**
+	 * 把 FromIndex 锚点上的 Count 个堆叠拆分到网格中第一个能放下的空位，位置由服务器决定，结果通过 FastArray 复制回来
+	 * @param ItemId 要拆分的道具
+	 * @param FromIndex 被拆分的锚点，拆分后至少留下一个堆叠
+	 * @param Count 拆出的数量
 	 */
 	UFUNCTION(Server, Reliable)
-	void Server_AddStacksToItem(UInv_ItemComponent* ItemComponent, int32 StackCount, int32 Remainder);
+	void Server_SplitItemStack(const FInv_ItemId& ItemId, const int32 FromIndex, const int32 Count);
+
+	/**
+	 * 丢弃道具，见 DropItem
+	 */
+	UFUNCTION(Server, Reliable)
+	void Server_DropItem(const FInv_ItemId& ItemId, const int32 StackCount);
 
 	void ToggleInventoryMenu();
+	bool IsInventoryMenuOpen() const { return bInventoryMenuOpen; }
 
 	/**
 	 * 实现 AddRepSubObject 方法来管理复制的子对象（新创建的InventoryItem）。
@@ -66,20 +195,115 @@ public:
 	 */
 	void AddRepSubObj(UObject* SubObj);
 
+	/** 与 AddRepSubObj 对应，道具离开道具栏时取消注册，避免复制系统继续考虑它 */
+	void RemoveRepSubObj(UObject* SubObj);
+
+	/** 道具离开道具栏时清除它在服务器网格模型中的锚点，否则这些格子会一直被占用 */
+	void ClearServerPlacements(const FInv_InventoryEntry& Entry);
+
 	FInventoryItemChange OnItemAdded;
 	FInventoryItemChange OnItemRemoved;
 	FNoRoomInInventory NoRoomInInventory;
 	FStackChange OnStackChange;
 
+	/** 预测的堆叠结果与服务器不一致时广播，UI 需要撤销预测并应用权威结果（两者都可能为空） */
+	FStackReconcile OnStackReconciled;
+
+	/** 已有道具被复制更新，ChangeFlags 说明变化了哪些内容，UI 只需要刷新对应的部分 */
+	FInventoryItemChanged OnItemChanged;
+
 protected:
 	virtual void BeginPlay() override;
 
+#if WITH_EDITOR
+	/** 编辑 GridSizes 时把尺寸限制在网格模型支持的范围内 */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 private:
 	void ConstructInventory();
 
+	/**
+	 * 本地预测一次添加，堆叠到已有道具时立即广播 OnStackChange 并记下预测结果
+	 * @return 预测中是否有空间
+	 */
+	bool PredictAddItem(const int32 PredictionKey, UInv_ItemComponent* ItemComponent,
+	                    FInv_SlotAvailabilityResult& Result);
+
+	/**
+	 * 服务器端：计算放置并写入服务器网格模型与 FastArray
+	 * @param BatchNewItemIds 同一批次中已经加入的新道具，它们不会作为堆叠目标；本次新加入的道具会追加进去
+	 */
+	FInv_ItemAddAck AddItem_Authority(const FInv_ItemAddRequest& Request, TArray<FInv_ItemId>& BatchNewItemIds);
+
+	/** 新道具加入 FastArray 之后的处理 */
+	void OnNewItemAdded(UInv_ItemComponent* ItemComponent, const FInv_ItemId NewItemId);
+
+	void AddStacksToItem(UInv_ItemComponent* ItemComponent, const FInv_ItemId ItemId, int32 StackCount, int32 Remainder);
+
+	void ConstructServerGridModels();
+
+	/**
+	 * 在服务器网格模型的副本上验证布局更新，全部合法才提交并写回 FastArray，不合法时让客户端回到服务器的布局
+	 * @return 是否接受了更新
+	 */
+	bool ApplyPlacementUpdates(const TArray<FInv_ItemPlacementUpdate>& Updates);
+
+	/** 不可堆叠的道具最多一个锚点，可堆叠道具各锚点的数量之和不超过总数 */
+	static bool IsValidPlacementCount(const FInv_InventoryEntry& Entry, const TArray<FInv_GridPlacement>& Placements);
+
+	/** 从堆叠数量最少的锚点开始移除 StackCount 个堆叠，并写回布局与总数 */
+	void RemoveStacksFromItem(const FInv_InventoryEntry& Entry, int32 StackCount);
+
+	/**
+	 * 在拥有者面前生成被丢弃的道具
+	 * @return 是否生成并初始化了掉落的道具，失败时调用方不应该移除背包中的道具
+	 */
+	bool SpawnDroppedItem(const FInv_InventoryEntry& Entry, const int32 StackCount);
+
+	/** 组件与道具子对象的复制条件 */
+	ELifetimeCondition GetReplicationCondition() const;
+
+	/** 服务器端：按 ReplicationPolicy 设置组件的复制条件，需要时创建订阅者的 NetGroup */
+	void ApplyReplicationPolicy();
+
+	/** 把组件或道具子对象加入/移出订阅者的 NetGroup */
+	void RegisterInObserverGroup(UObject* SubObj) const;
+	void UnregisterFromObserverGroup(UObject* SubObj) const;
+
+	/** 本地也是服务器（Listen Server / Standalone）时 FastArray 的复制回调不会触发，需要自己广播 */
+	bool ShouldBroadcastLocally() const;
+
+	/** 把服务器网格模型中道具的布局写回 FastArray 条目 */
+	void WriteBackPlacements(const FInv_ItemId ItemId, const EInv_ItemCategory Category);
+
+	static bool IsSamePlacement(const FInv_SlotAvailabilityResult& A, const FInv_SlotAvailabilityResult& B);
+
+	/** FastArray 修改条目时需要把 InventoryList 标记为 Dirty */
+	friend struct FInv_InventoryFastArray;
+
+	/** Push Model 复制：只有 FastArray 标记过 Dirty 的网络更新才会比较它，空闲的道具栏没有任何开销 */
 	UPROPERTY(Replicated)
 	FInv_InventoryFastArray InventoryList;
 
+	/**
+	 * 道具数据的存放方式。Object 为每个道具创建一个复制的子对象；
+	 * Inline 把道具数据放在 FastArray 条目里，适合道具数量很多的道具栏（箱子、仓库）
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	EInv_ItemStorageMode ItemStorageMode{EInv_ItemStorageMode::Object};
+
+	/**
+	 * 道具栏（组件本身与道具子对象）复制给哪些连接。
+	 * 拥有道具栏的 Actor 本身也必须与订阅者相关才能收到，PlayerController 只与它的拥有者相关，
+	 * 放在这类 Actor 上时 OwnerAndObservers 会触发 ensure 并退回 OwnerOnly。
+	 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	EInv_InventoryReplicationPolicy ReplicationPolicy{EInv_InventoryReplicationPolicy::OwnerOnly};
+
+	/** OwnerAndObservers 时组件与道具子对象所在的 NetGroup，每个道具栏一个 */
+	FName ObserverNetGroup;
+
 	TWeakObjectPtr<APlayerController> OwningController;
 
 	/** Widget */
@@ -89,6 +313,26 @@ private:
 	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
 	TSubclassOf<UInv_InventoryBase> InventoryMenuClass;
 
+	/** 丢弃道具时生成的 Actor，需要带有 UInv_ItemComponent；为空时丢弃的道具直接消失 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	TSubclassOf<AActor> DropActorClass;
+
+	/** 丢弃的道具生成在拥有者前方多远的位置 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	float DropSpawnDistance{100.f};
+
+	/** 每个分类网格的尺寸（X 为列数，Y 为行数），服务器的网格模型和道具栏 Widget 中的网格都从这里读取 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	TMap<EInv_ItemCategory, FIntPoint> GridSizes;
+
+	/** 服务器端的网格模型，放置的权威数据 */
+	TMap<EInv_ItemCategory, FInv_SpatialGridModel> ServerGridModels;
+
+	/** 客户端尚未得到确认的堆叠预测 */
+	TMap<int32, FInv_SlotAvailabilityResult> PendingStackPredictions;
+
+	int32 NextPredictionKey{0};
+
 	bool bInventoryMenuOpen;
 	void OpenInventoryMenu();
 	void CloseInventoryMenu();
@@ -1,14 +1,30 @@
 ﻿#pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
 #include "Net/Serialization/FastArraySerializer.h"
+#include "Items/Inv_ItemHandle.h"
+#include "Items/Inv_ItemInstance.h"
+#include "Types/Inv_GridTypes.h"
 
 #include "Inv_FastArray.generated.h"
 
-struct FGameplayTag;
 class UInv_ItemComponent;
 class UInv_InventoryComponent;
 class UInv_InventoryItem;
+class UInv_ItemDefinition;
+
+/**
+ * 道具实例数据的存放方式
+ */
+UENUM(BlueprintType)
+enum class EInv_ItemStorageMode : uint8
+{
+	/** 每个道具一个 UInv_InventoryItem 子对象，数据在子对象上单独复制 */
+	Object,
+	/** 道具数据直接内联在 FastArray 条目中，不创建 UObject，也没有子对象复制与 GC 开销 */
+	Inline
+};
 
 /** A single entry in an inventory */
 USTRUCT(BlueprintType)
@@ -21,13 +37,58 @@ public:
 	{
 	}
 
+	FInv_ItemId GetItemId() const { return ItemId; }
+
+	/** 道具对应的 UObject，内联存储时为 nullptr */
+	UInv_InventoryItem* GetItemObject() const { return Item; }
+
+	const FInv_ItemManifest& GetItemManifest() const;
+	bool IsStackable() const;
+
+	/** 道具数据没有单独修改过时返回共享的道具定义，否则返回 nullptr */
+	UInv_ItemDefinition* GetSharedItemDefinition() const;
+	int32 GetTotalStackCount() const { return TotalStackCount; }
+	const TArray<FInv_GridPlacement>& GetPlacements() const { return Placements; }
+
 private:
 	friend struct FInv_InventoryFastArray;
 	friend UInv_InventoryComponent;
 
-	// 要存储的道具的指针
+	// 服务器分配的道具 ID，在所属道具栏内唯一，UI 与 RPC 都通过它引用道具
+	UPROPERTY()
+	FInv_ItemId ItemId;
+
+	// 要存储的道具的指针，只有 UObject 存储模式下才有
 	UPROPERTY()
 	TObjectPtr<UInv_InventoryItem> Item = nullptr;
+
+	// 内联存储模式下的道具数据
+	UPROPERTY()
+	FInv_ItemInstance Instance;
+
+	// 道具所在的网格
+	UPROPERTY()
+	EInv_ItemCategory GridCategory{EInv_ItemCategory::None};
+
+	// 道具在网格中的所有锚点及各自的堆叠数量，由服务器写入，客户端直接按它布局而不再自己求解
+	UPROPERTY()
+	TArray<FInv_GridPlacement> Placements;
+
+	// 道具的总堆叠数量，作为条目的一部分走 FastArray 的 Delta 复制
+	UPROPERTY()
+	int32 TotalStackCount{0};
+
+	// 客户端上一次处理过的布局，用来判断复制更新中布局是否变化
+	UPROPERTY(NotReplicated)
+	TArray<FInv_GridPlacement> AppliedPlacements;
+
+	// 客户端上一次处理过的总堆叠数量
+	UPROPERTY(NotReplicated)
+	int32 AppliedTotalStackCount{0};
+
+	// 条目登记在类型索引中时使用的道具类型；客户端上道具定义或子对象可能晚于条目解析，为空表示还没有登记
+	UPROPERTY(NotReplicated)
+	FGameplayTag IndexedItemType;
 };
 
 /** List of inventory items */
@@ -45,12 +106,14 @@ public:
 	{
 	}
 
-	TArray<UInv_InventoryItem*> GetAllItems() const;
+	/** 道具栏中所有道具的句柄 */
+	TArray<FInv_ItemHandle> GetAllItems() const;
 
 	// 添加或移除条目时的事件回调，可以在这里通知道具系统发生了数据变化，尽量确保这里只实现客户端侧的逻辑
 	//~ FFastArraySerializer contract ~//
 	void PreReplicatedRemove(const TArrayView<int32> RemovedIndices, int32 FinalSize);
 	void PostReplicatedAdd(const TArrayView<int32> AddedIndices, int32 FinalSize);
+	void PostReplicatedChange(const TArrayView<int32> ChangedIndices, int32 FinalSize);
 	//~ End of FFastArraySerializer contract ~//
 
 	// Delta 序列化函数，必须实现。
@@ -70,19 +133,74 @@ public:
 	}
 
 	// 实际添加/移除条目函数的工具函数
-	UInv_InventoryItem* AddEntry(UInv_ItemComponent* ItemComponent);
-	UInv_InventoryItem* AddEntry(UInv_InventoryItem* Item);
-	void RemoveEntry(UInv_InventoryItem* Item);
-	UInv_InventoryItem* FindFirstItemByType(const FGameplayTag& ItemType);
+	/** 按 StorageMode 创建道具子对象或内联道具数据，返回新道具的 ID */
+	FInv_ItemId AddEntry(UInv_ItemComponent* ItemComponent, const EInv_ItemStorageMode StorageMode);
+	void RemoveEntry(const FInv_ItemId ItemId);
+	/** 一次移除多个道具，整批只标记一次数列 Dirty */
+	void RemoveEntries(const TArrayView<const FInv_ItemId> ItemIds);
+	/** 最早加入的该类型道具的 ID（跳过 ExcludedItemIds 中的道具），没有时返回空 ID */
+	FInv_ItemId FindFirstItemByType(const FGameplayTag& ItemType,
+	                                const TConstArrayView<FInv_ItemId> ExcludedItemIds = {}) const;
+
+	const FInv_InventoryEntry* FindEntry(const FInv_ItemId ItemId) const;
+
+	/** 道具在网格中的布局，道具不在列表中时返回 nullptr */
+	const TArray<FInv_GridPlacement>* FindPlacements(const FInv_ItemId ItemId) const;
+
+	/** 服务器写入道具的布局，有变化时标记条目 Dirty */
+	void SetPlacements(const FInv_ItemId ItemId, const EInv_ItemCategory Category,
+	                   const TArray<FInv_GridPlacement>& Placements);
+
+	/** 服务器写入道具的总堆叠数量，同步到 InventoryItem（如果有）并标记条目 Dirty */
+	void SetTotalStackCount(const FInv_ItemId ItemId, const int32 Count);
+
+	/** 强制重新复制道具的条目，用于让客户端回到服务器的布局 */
+	void MarkItemEntryDirty(const FInv_ItemId ItemId);
 
 private:
 	friend UInv_InventoryComponent;
 
+	/** 维护类型索引，服务器在 AddEntry/RemoveEntry 中调用，客户端在复制回调中调用 */
+	void AddToTypeIndex(FInv_InventoryEntry& Entry);
+	void RemoveFromTypeIndex(FInv_InventoryEntry& Entry);
+
+	FInv_InventoryEntry* FindEntry(const FInv_ItemId ItemId);
+
+	/**
+	 * 标记条目/数列 Dirty。InventoryList 使用 Push Model 复制，
+	 * 除了 FastArray 自己的 Dirty 标记，还要把拥有者组件上的 InventoryList 属性标记为 Dirty，否则这次修改不会被发送
+	 */
+	void MarkEntryDirty(FInv_InventoryEntry& Entry);
+	void MarkEntriesDirty();
+	void MarkOwnerPropertyDirty() const;
+
+	/** 用最后一个条目填补被移除的位置，不移动其余条目；返回是否找到了道具 */
+	bool RemoveEntryAtSwap(const FInv_ItemId ItemId);
+
+	void RebuildEntryIndices() const;
+
 	// 被包装的 TArray
 	// Replicated list of items
 	UPROPERTY()
 	TArray<FInv_InventoryEntry> Entries;
 
+	/**
+	 * 道具类型 -> 该类型的所有道具 ID（按加入顺序），不参与复制，两端各自维护。
+	 * 查找同类道具时不再需要遍历 Entries 并逐个读取 Manifest。
+	 */
+	TMap<FGameplayTag, TArray<FInv_ItemId, TInlineAllocator<1>>> ItemsByType;
+
+	/**
+	 * 道具 ID -> 条目在 Entries 中的下标，不参与复制。
+	 * 服务器在添加/移除时直接维护；客户端的条目由复制系统增删（顺序也会变），只标记失效，下次查找时重建。
+	 * FastArray 靠 ReplicationID 对应条目，所以服务器可以放心地交换条目顺序。
+	 */
+	mutable TMap<FInv_ItemId, int32> EntryIndices;
+	mutable bool bEntryIndicesDirty{false};
+
+	/** 服务器上最后分配的道具 ID */
+	FInv_ItemId LastItemId;
+
 	UPROPERTY(NotReplicated)
 	TObjectPtr<UActorComponent> OwnerComponent;
 };
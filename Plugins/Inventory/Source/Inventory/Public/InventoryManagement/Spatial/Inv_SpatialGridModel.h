@@ -0,0 +1,213 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+#include "Types/Inv_GridTypes.h"
+
+struct FInv_ItemManifest;
+
+/**
+ * 道具网格的空间数据模型，不依赖任何 Widget。
+ * 所有放置状态（占用、锚点、堆叠数量、道具）都以 SoA（Structure of Arrays）的形式按格子 Index 平铺存储，
+ * 放置相关的查询因此只是对连续数组的扫描，可以在服务器和单元测试中脱离 Slate 运行。
+ * UInv_InventoryGrid 只负责根据这里的数据渲染。
+ *
+ * 占用信息以“位棋盘”（Bitboard）的形式保存：每一行是一个 uint64，第 X 位表示第 X 列是否被占用。
+ * 因此“WxH 的道具能否放在 (X, Y)”只需要对 H 行做移位和按位与，查找第一个可用锚点时也可以一次处理一整行的所有锚点。
+ */
+struct INVENTORY_API FInv_SpatialGridModel
+{
+public:
+	/** 一行用一个 uint64 表示，所以列数不能超过 64 */
+	static constexpr int32 MaxColumns = 64;
+
+	/** 行列数都至少为 1，且列数不超过 MaxColumns */
+	static bool IsValidSize(const int32 InRows, const int32 InColumns)
+	{
+		return InRows > 0 && InColumns > 0 && InColumns <= MaxColumns;
+	}
+
+	/** 尺寸不合法（见 IsValidSize）时触发 ensure，模型保持为空网格 */
+	void Initialize(const int32 InRows, const int32 InColumns);
+
+	int32 GetRows() const { return Rows; }
+	int32 GetColumns() const { return Columns; }
+	int32 Num() const { return Rows * Columns; }
+	bool IsValidIndex(const int32 Index) const { return Index >= 0 && Index < Num(); }
+
+	/** 格子上是否有道具 */
+	bool IsOccupied(const int32 Index) const { return (RowMasks[Index / Columns] >> (Index % Columns)) & 1ull; }
+
+	/** 占据该格子的道具的锚点（左上角）Index，没有道具时为 INDEX_NONE */
+	int32 GetUpperLeftIndex(const int32 Index) const { return UpperLeftIndices[Index]; }
+
+	/** 格子上记录的堆叠数量，只有锚点格子上才有意义 */
+	int32 GetStackCount(const int32 Index) const { return StackCounts[Index]; }
+	void SetStackCount(const int32 Index, const int32 Count) { StackCounts[Index] = Count; }
+
+	/** 占据该格子的道具的 ID（任意一格都可以，会通过锚点查找），没有道具时为空 ID */
+	FInv_ItemId GetItemId(const int32 Index) const;
+
+	/** 判断从 StartIndex 开始放置 Dimensions 大小的道具是否会超出网格边界 */
+	bool IsInGridBounds(const int32 StartIndex, const FIntPoint& Dimensions) const;
+
+	/** 在 UpperLeftIndex 处放下道具，并让它占据 Dimensions 范围内的所有格子 */
+	void PlaceItem(const FInv_ItemId ItemId, const FGameplayTag& ItemType, const int32 UpperLeftIndex,
+	               const FIntPoint& Dimensions, const int32 StackCount);
+
+	/**
+	 * 把 FindRoomForItem 的结果直接写进模型：空格子按道具类型占用，已有道具的格子增加堆叠数量。
+	 * 在模型的副本上规划多个道具的放置时道具还没有 ID，ItemId 可以为空。
+	 */
+	void ReserveRoom(const FInv_SlotAvailabilityResult& Result, const FInv_ItemManifest& Manifest,
+	                 const FInv_ItemId ItemId = FInv_ItemId());
+
+	/** 按 Index 顺序收集道具在网格中的所有锚点及堆叠数量 */
+	void GetPlacements(const FInv_ItemId ItemId, TArray<FInv_GridPlacement>& OutPlacements) const;
+
+	/** 清空道具的所有锚点 */
+	void ClearPlacements(const FInv_ItemId ItemId, const FInv_ItemManifest& Manifest);
+
+	/**
+	 * 检查放置是否合法（不越界、不与其他道具重叠、堆叠数量在范围内），合法时放下道具
+	 * @return 是否放下了道具
+	 */
+	bool TryPlaceItem(const FInv_ItemId ItemId, const FInv_ItemManifest& Manifest, const FInv_GridPlacement& Placement);
+
+	/** 清空 UpperLeftIndex 处的道具所占据的所有格子 */
+	void ClearItem(const int32 UpperLeftIndex, const FIntPoint& Dimensions);
+
+	/**
+	 * 在网格中查找所有可以给要添加的道具用的格子
+	 * @param ExcludedItemIds 不能作为堆叠目标的道具，比如同一批次中刚刚加入的新道具
+	 */
+	FInv_SlotAvailabilityResult FindRoomForItem(const FInv_ItemManifest& Manifest,
+	                                            const TConstArrayView<FInv_ItemId> ExcludedItemIds = {}) const;
+
+	/** 以 (Position.X, Position.Y) 为左上角的 Dimensions 区域是否完全没有被占用 */
+	bool IsRegionFree(const FIntPoint& Position, const FIntPoint& Dimensions) const;
+
+	/**
+	 * 从 StartIndex 开始（包含）按 Index 顺序查找第一个能完整放下 Dimensions 大小道具的空闲锚点
+	 * @param Blocked 每行的阻挡掩码，通常是 RowMasks 加上本次查询已经认领的格子
+	 * @return 锚点 Index，找不到时为 INDEX_NONE
+	 */
+	int32 FindFirstFreeAnchor(const TArrayView<const uint64> Blocked, const FIntPoint& Dimensions,
+	                          const int32 StartIndex) const;
+
+	/** 整个网格中第一个能放下该道具的空闲锚点，找不到时为 INDEX_NONE */
+	int32 FindFreeAnchorForItem(const FInv_ItemManifest& Manifest) const;
+
+	/** 检查以 Position 为起点、Dimensions 大小的区域的可用性 */
+	FInv_SpaceQueryResult QuerySpace(const FIntPoint& Position, const FIntPoint& Dimensions) const;
+
+	/** 对以 Index 为起点、Range2D 大小的区域内的每个格子 Index 调用 Function，超出网格的部分会被裁掉 */
+	template <typename FuncT>
+	void ForEach2D(const int32 Index, const FIntPoint& Range2D, const FuncT& Function) const;
+
+	/** 按 Index 顺序对网格中的每个锚点 Index 调用 Function */
+	template <typename FuncT>
+	void ForEachAnchor(const FuncT& Function) const;
+
+private:
+	/** 每行一个 uint64 的掩码数组，网格不超过 32 行时不需要分配堆内存 */
+	using FRowMaskArray = TArray<uint64, TInlineAllocator<32>>;
+
+	/** Dimensions 大小的道具是否有可能放进网格（不考虑占用） */
+	bool CanFitInGrid(const FIntPoint& Dimensions) const;
+
+	/**
+	 * 根据阻挡掩码计算每行的横向可用位（OutFit）以及能完整放下道具的锚点（OutAnchors，共 Rows - Height + 1 行）。
+	 * 调用前需要确认 CanFitInGrid。
+	 */
+	void BuildFreeAnchorMasks(const TArrayView<const uint64> Blocked, const FIntPoint& Dimensions,
+	                          FRowMaskArray& OutFit, FRowMaskArray& OutAnchors) const;
+
+	void PlaceAnchor(const int32 UpperLeftIndex, const FIntPoint& Dimensions, const int32 StackCount,
+	                 const FGameplayTag& ItemType, const FInv_ItemId ItemId);
+
+	/**
+	 * 从 StartIndex 开始（包含）查找下一个可以继续堆叠的同类道具锚点。
+	 * 没有 ID 的锚点（规划中预留、还没有真正加入的道具）和 ExcludedItemIds 中的道具都不会作为堆叠目标。
+	 */
+	int32 FindNextStackAnchor(const int32 StartIndex, const FGameplayTag& ItemType, const int32 MaxStackSize,
+	                          const TConstArrayView<FInv_ItemId> ExcludedItemIds) const;
+	int32 GetStackAmount(const int32 Index) const;
+
+	/** 对道具的每个锚点 Index 调用 Function */
+	template <typename FuncT>
+	void ForEachAnchorOf(const FInv_ItemId ItemId, const FuncT& Function) const;
+
+	/** 宽度为 Width 的道具在一行上所占据的掩码（从第 0 列开始） */
+	static uint64 GetWidthMask(const int32 Width);
+
+	int32 Rows{0};
+	int32 Columns{0};
+
+	/** 有效列对应的位 */
+	uint64 ColumnMask{0};
+
+	/** 每行一个 uint64，第 X 位表示该格子被占用 */
+	TArray<uint64> RowMasks;
+
+	/** 每行一个 uint64，第 X 位表示该格子是某个道具的锚点 */
+	TArray<uint64> AnchorMasks;
+
+	/** 每个格子所属道具的锚点 Index */
+	TArray<int32> UpperLeftIndices;
+
+	/** 每个格子的堆叠数量，只在锚点上写入 */
+	TArray<int32> StackCounts;
+
+	/** 锚点上道具的类型，用来判断能否堆叠，避免在查询中查找道具 */
+	TArray<FGameplayTag> ItemTypes;
+
+	/** 锚点上道具的 ID */
+	TArray<FInv_ItemId> ItemIds;
+};
+
+template <typename FuncT>
+void FInv_SpatialGridModel::ForEachAnchor(const FuncT& Function) const
+{
+	for (int32 Row = 0; Row < Rows; ++Row)
+	{
+		for (uint64 Anchors = AnchorMasks[Row]; Anchors != 0; Anchors &= Anchors - 1)
+		{
+			Function(Row * Columns + static_cast<int32>(FMath::CountTrailingZeros64(Anchors)));
+		}
+	}
+}
+
+template <typename FuncT>
+void FInv_SpatialGridModel::ForEachAnchorOf(const FInv_ItemId ItemId, const FuncT& Function) const
+{
+	if (!ItemId.IsValid()) return;
+
+	ForEachAnchor([&](const int32 Index)
+	{
+		if (ItemIds[Index] == ItemId)
+		{
+			Function(Index);
+		}
+	});
+}
+
+template <typename FuncT>
+void FInv_SpatialGridModel::ForEach2D(const int32 Index, const FIntPoint& Range2D, const FuncT& Function) const
+{
+	if (!IsValidIndex(Index)) return;
+
+	const int32 StartColumn = Index % Columns;
+	const int32 StartRow = Index / Columns;
+	const int32 EndColumn = FMath::Min(StartColumn + Range2D.X, Columns);
+	const int32 EndRow = FMath::Min(StartRow + Range2D.Y, Rows);
+
+	for (int32 Row = StartRow; Row < EndRow; ++Row)
+	{
+		const int32 RowOffset = Row * Columns;
+		for (int32 Column = StartColumn; Column < EndColumn; ++Column)
+		{
+			Function(RowOffset + Column);
+		}
+	}
+}
@@ -7,6 +7,8 @@
 #include "Items/Manifest/Inv_ItemManifest.h"
 #include "Inv_ItemComponent.generated.h"
 
+class UInv_ItemDefinition;
+
 /**
  * ItemComponent 是用于 Actor 的，并不代表 InventoryItem。
  * 主要的交互对象是 InventoryComponent。
@@ -22,20 +24,57 @@ public:
 	virtual void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
 
 	/** InventoryComponent 会把 Manifest 复制下来，创建一个新 inventoryItem，随后通过当前组件销毁 Owner Actor。 */
-	FInv_ItemManifest GetItemManifest() const { return ItemManifest; }
+	const FInv_ItemManifest& GetItemManifest() const;
+
+	/**
+	 * 修改场景中道具的 Fragment（比如捡走一部分后剩余的堆叠数量）。
+	 * 道具定义是共享的，不能修改，所以第一次调用时把定义中的 Manifest 复制到组件自身，之后不再使用定义。
+	 * ItemManifest 使用 Push Model 复制，每次调用都会把它标记为 Dirty。
+	 */
+	FInv_ItemManifest& GetMutableItemManifest();
+
+	/** 道具定义，设置后创建的 InventoryItem 只引用它而不复制 Manifest */
+	UInv_ItemDefinition* GetItemDefinition() const { return ItemDefinition; }
 
 	FString GetPickupMessage() const { return PickupMessage; }
 
+	/**
+	 * 服务器生成被丢弃的道具后立即调用，在第一次复制之前设置好道具数据。
+	 * 有道具定义时只引用定义，堆叠数量与定义不同时才复制一份 Manifest。
+	 */
+	void InitializeDroppedItem(UInv_ItemDefinition* InItemDefinition, const FInv_ItemManifest& InItemManifest,
+	                           const int32 StackCount);
+
 	void PickedUp();
 
 protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#if WITH_EDITOR
+	/** 编辑 Manifest 后让它的 Fragment 查找表失效 */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 	UFUNCTION(BlueprintImplementableEvent, Category="Inventory")
 	void OnPickedUp();
 
 private:
+	/** 设置了道具定义时使用定义中的 Manifest，ItemManifest 只在没有定义时使用 */
 	UPROPERTY(Replicated, EditAnywhere, Category="Inventory")
+	TObjectPtr<UInv_ItemDefinition> ItemDefinition;
+
+	UPROPERTY(ReplicatedUsing=OnRep_ItemManifest, EditAnywhere, Category="Inventory")
 	FInv_ItemManifest ItemManifest;
 
+	/** 复制写入 Manifest 后，让它的 Fragment 查找表失效 */
+	UFUNCTION()
+	void OnRep_ItemManifest();
+
 	UPROPERTY(EditAnywhere, Category="Inventory")
 	FString PickupMessage;
+
+	/** Owner 移动后更新它在 UInv_PickupSubsystem 中的位置 */
+	void OnOwnerTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
+	                             ETeleportType Teleport);
 };
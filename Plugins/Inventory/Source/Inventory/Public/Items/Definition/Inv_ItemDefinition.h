@@ -0,0 +1,40 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Items/Manifest/Inv_ItemManifest.h"
+#include "Inv_ItemDefinition.generated.h"
+
+class UInv_InventoryItem;
+
+/**
+ * 道具定义：同一种道具所有实例共享的、只读的 Manifest。
+ * InventoryItem 只引用定义并保存自己的可变状态（堆叠数量等），不再各自复制一份完整的 Manifest。
+ * 定义是资产，网络复制时只需要传一个 NetGUID；作为 PrimaryAsset 也可以通过 Asset Manager 按 ID 查找与加载。
+ */
+UCLASS(BlueprintType)
+class INVENTORY_API UInv_ItemDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+#if WITH_EDITOR
+	/** 编辑 Manifest 后让它的 Fragment 查找表失效 */
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	const FInv_ItemManifest& GetItemManifest() const { return ItemManifest; }
+
+	/** 创建一个引用该定义的 InventoryItem */
+	UInv_InventoryItem* Manifest(UObject* NewOuter);
+
+private:
+	UPROPERTY(EditDefaultsOnly, Category="Inventory")
+	FInv_ItemManifest ItemManifest;
+};
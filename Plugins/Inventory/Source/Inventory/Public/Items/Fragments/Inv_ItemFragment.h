@@ -57,14 +57,15 @@ struct FInv_ImageFragment : public FInv_ItemFragment
 	GENERATED_BODY()
 
 public:
-	UTexture2D* GetIcon() const { return Icon; }
-	void SetIcon(UTexture2D* InIcon) { this->Icon = InIcon; }
+	const TSoftObjectPtr<UTexture2D>& GetIcon() const { return Icon; }
+	void SetIcon(const TSoftObjectPtr<UTexture2D>& InIcon) { this->Icon = InIcon; }
 	FVector2D GetIconDimensions() const { return IconDimensions; }
 	void SetIconDimensions(const FVector2D& InIconDimensions) { this->IconDimensions = InIconDimensions; }
 
 private:
+	// 软引用：场景中的拾取物和道具的 Manifest 不会让图标常驻内存，显示时再由 UInv_IconSubsystem 异步加载
 	UPROPERTY(EditAnywhere, Category="Inventory")
-	TObjectPtr<UTexture2D> Icon{nullptr};
+	TSoftObjectPtr<UTexture2D> Icon;
 
 	UPROPERTY(EditAnywhere, Category="Inventory")
 	FVector2D IconDimensions{44.f, 44.f};
@@ -77,6 +78,7 @@ struct FInv_StackableFragment : public FInv_ItemFragment
 
 public:
 	int32 GetMaxStackSize() const { return MaxStackSize; }
+	void SetMaxStackSize(const int32 InMaxStackSize) { MaxStackSize = InMaxStackSize; }
 	int32 GetStackCount() const { return StackCount; }
 	void SetStackCount(const int32 InStackCount) { StackCount = InStackCount; }
 
@@ -4,12 +4,15 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Object.h"
-#include "Items/Manifest/Inv_ItemManifest.h"
+#include "Items/Inv_ItemInstance.h"
+#include "Types/Inv_ItemId.h"
 #include "Inv_InventoryItem.generated.h"
 
+class UInv_ItemDefinition;
+
 /**
  * 道具作为数据时的抽象表现
- * 这个道具类会放在 FastArray 里面用
+ * 这个道具类会放在 FastArray 里面用；道具栏使用内联存储（EInv_ItemStorageMode::Inline）时不会创建它
  */
 UCLASS()
 class INVENTORY_API UInv_InventoryItem : public UObject
@@ -24,22 +27,48 @@ public:
 	// 如果不重载并返回 true，AddReplicatedSubObject 会跳过它，客户端根本拿不到这个新创建的物品对象，PostReplicatedAdd／OnItemAdded 也就不会触发。
 	virtual bool IsSupportedForNetworking() const override { return true; }
 
+	//--------------------------------
+	// Instance 与 ItemId 使用 Push Model 复制：服务器不再每次网络更新都比较它们，
+	// 所有修改都必须经过下面的 Setter，由它们标记属性 Dirty。
+	//--------------------------------
+
+	/** 没有道具定义时的兜底：道具持有一份自己的完整 Manifest */
 	void SetItemManifest(const FInv_ItemManifest& Manifest);
-	const FInv_ItemManifest& GetItemManifest() const { return ItemManifest.Get<FInv_ItemManifest>(); }
-	FInv_ItemManifest& GetMutableManifest() { return ItemManifest.GetMutable<FInv_ItemManifest>(); }
-	bool IsStackable() const;
+	void SetItemManifest(FInv_ItemManifest&& Manifest);
+
+	/** 引用共享的道具定义，不复制 Manifest */
+	void SetItemDefinition(UInv_ItemDefinition* InDefinition);
+	UInv_ItemDefinition* GetItemDefinition() const { return Instance.GetItemDefinition(); }
+
+	/** 有自己的 Manifest（兜底或写时复制之后）时返回它，否则返回道具定义中共享的 Manifest */
+	const FInv_ItemManifest& GetItemManifest() const { return Instance.GetItemManifest(); }
+
+	/** 写时复制：第一次需要修改 Fragment 时才把道具定义中的 Manifest 复制一份到道具自身，同时标记 Instance Dirty */
+	FInv_ItemManifest& GetMutableManifest();
+
+	/** 道具是否持有自己的 Manifest 副本 */
+	bool HasManifestOverride() const { return Instance.HasManifestOverride(); }
+	bool IsStackable() const { return Instance.IsStackable(); }
 	int32 GetTotalStackCount() const { return TotalStackCount; }
 	void SetTotalStackCount(int32 Count) { TotalStackCount = Count; }
 
+	/** 道具在道具栏中的 ID，与 FastArray 条目中的 ID 相同 */
+	FInv_ItemId GetItemId() const { return ItemId; }
+	void SetItemId(const FInv_ItemId InItemId);
+
 private:
-	/**
-	 * 每个InventoryItem实例都拥有自己的Manifest副本，用于保存创建该物品时的相关信息。
-	 * 使用FInstancedStruct存储Manifest，使其支持多态、蓝图访问以及更灵活的扩展性。
-	 */
-	UPROPERTY(VisibleAnywhere, meta=(BaseStruct="/Script/Inventory.Inv_ItemManifest"), Replicated)
-	FInstancedStruct ItemManifest;
+	/** 道具定义与可选的 Manifest 副本 */
+	UPROPERTY(VisibleAnywhere, ReplicatedUsing=OnRep_Instance)
+	FInv_ItemInstance Instance;
+
+	/** 复制写入 Manifest 后，让它的 Fragment 查找表失效并通知 UI */
+	UFUNCTION()
+	void OnRep_Instance();
 
 	UPROPERTY(Replicated)
+	FInv_ItemId ItemId;
+
+	/** 总堆叠数量，由 FastArray 条目复制并同步过来，这里只是方便访问的副本 */
 	int32 TotalStackCount{0};
 };
 
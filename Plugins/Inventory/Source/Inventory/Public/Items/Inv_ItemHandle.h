@@ -0,0 +1,61 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/Manifest/Inv_ItemManifest.h"
+#include "Types/Inv_ItemId.h"
+#include "Inv_ItemHandle.generated.h"
+
+class UInv_InventoryComponent;
+class UInv_InventoryItem;
+struct FInv_InventoryEntry;
+
+/**
+ * 道具栏中一个道具的句柄：道具栏 + 服务器分配的道具 ID。
+ * 无论道具是 UInv_InventoryItem 子对象还是内联在 FastArray 条目中的数据，UI 与玩法代码都通过它访问道具，
+ * 每次访问都会重新在道具栏中查找，道具被移除后句柄自动失效。
+ */
+USTRUCT(BlueprintType)
+struct INVENTORY_API FInv_ItemHandle
+{
+	GENERATED_BODY()
+
+public:
+	FInv_ItemHandle() = default;
+	FInv_ItemHandle(const UInv_InventoryComponent* InInventory, const FInv_ItemId InItemId);
+
+	FInv_ItemId GetItemId() const { return ItemId; }
+	const UInv_InventoryComponent* GetInventory() const { return Inventory.Get(); }
+
+	/** 道具是否还在道具栏中 */
+	bool IsValid() const { return FindEntry() != nullptr; }
+
+	const FInv_InventoryEntry* FindEntry() const;
+
+	/** 道具的 Manifest，句柄失效时返回空的 Manifest */
+	const FInv_ItemManifest& GetItemManifest() const;
+
+	int32 GetTotalStackCount() const;
+	bool IsStackable() const;
+
+	/** 道具对应的 UObject，只有道具栏使用 UObject 存储时才有 */
+	UInv_InventoryItem* GetItemObject() const;
+
+	bool operator==(const FInv_ItemHandle& Other) const
+	{
+		return ItemId == Other.ItemId && Inventory == Other.Inventory;
+	}
+
+	bool operator!=(const FInv_ItemHandle& Other) const { return !(*this == Other); }
+
+private:
+	TWeakObjectPtr<const UInv_InventoryComponent> Inventory;
+	FInv_ItemId ItemId;
+};
+
+template <typename FragmentType>
+const FragmentType* GetFragment(const FInv_ItemHandle& Item, const FGameplayTag& Tag)
+{
+	return Item.GetItemManifest().GetFragmentOfTypeWithTag<FragmentType>(Tag);
+}
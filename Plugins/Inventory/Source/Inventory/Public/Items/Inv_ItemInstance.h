@@ -0,0 +1,54 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Items/Manifest/Inv_ItemManifest.h"
+#include "StructUtils/InstancedStruct.h"
+#include "Inv_ItemInstance.generated.h"
+
+class UInv_ItemDefinition;
+
+/**
+ * 一个道具实例的数据：引用共享的道具定义，需要修改 Fragment 时才持有自己的 Manifest 副本。
+ * UInv_InventoryItem 用它保存数据；道具栏使用内联存储时，它直接放在 FastArray 条目里，不需要任何 UObject。
+ */
+USTRUCT()
+struct INVENTORY_API FInv_ItemInstance
+{
+	GENERATED_BODY()
+
+public:
+	/** 没有道具定义时的兜底：道具持有一份自己的完整 Manifest */
+	void SetItemManifest(const FInv_ItemManifest& Manifest);
+	void SetItemManifest(FInv_ItemManifest&& Manifest);
+
+	/** 引用共享的道具定义，不复制 Manifest */
+	void SetItemDefinition(UInv_ItemDefinition* InDefinition);
+	UInv_ItemDefinition* GetItemDefinition() const { return Definition; }
+
+	/**
+	 * 有自己的 Manifest（兜底或写时复制之后）时返回它，否则返回道具定义中共享的 Manifest。
+	 * 两者都没有（比如客户端上道具定义的引用还没有解析）时返回空的 Manifest。
+	 */
+	const FInv_ItemManifest& GetItemManifest() const;
+
+	/** 写时复制：第一次需要修改 Fragment 时才把道具定义中的 Manifest 复制一份到道具自身 */
+	FInv_ItemManifest& GetMutableManifest();
+
+	/** 道具是否持有自己的 Manifest 副本 */
+	bool HasManifestOverride() const { return ItemManifest.IsValid(); }
+	bool IsStackable() const;
+
+	/** 复制写入之后调用，让 Manifest 副本的 Fragment 查找表失效 */
+	void PostReplicatedUpdate() const;
+
+private:
+	/** 共享的道具定义，复制时只传一个 NetGUID */
+	UPROPERTY(VisibleAnywhere, Category="Inventory")
+	TObjectPtr<UInv_ItemDefinition> Definition;
+
+	/** 道具自己的 Manifest 副本，默认为空 */
+	UPROPERTY(VisibleAnywhere, Category="Inventory", meta=(BaseStruct="/Script/Inventory.Inv_ItemManifest"))
+	FInstancedStruct ItemManifest;
+};
@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 
 #include "CoreMinimal.h"
 #include "GameplayTagContainer.h"
@@ -12,14 +12,44 @@
 
 struct FInv_ItemFragment;
 
+/**
+ * Fragment 查找表中的一项：Fragments[FragmentIndex] 是 Type 类型（或其子类型）的 Fragment。
+ * 每个 Fragment 会为它自己的类型以及所有父类型各登记一项，这样按父类型查找也只是一次指针比较。
+ * FragmentType 记录构建时 Fragment 的实际类型，访问前用它确认 Fragments[FragmentIndex] 没有在背后被替换。
+ */
+struct FInv_FragmentLookupEntry
+{
+	const UScriptStruct* Type{nullptr};
+	const UScriptStruct* FragmentType{nullptr};
+	FGameplayTag FragmentTag;
+	int32 FragmentIndex{INDEX_NONE};
+};
+
 USTRUCT(BlueprintType)
 struct INVENTORY_API FInv_ItemManifest
 {
 	GENERATED_BODY()
 
 public:
-	/** 提供一个Manifest()方法，用于根据自身数据创建新的InventoryItem实例 */
-	UInv_InventoryItem* Manifest(UObject* NewOuter);
+	FInv_ItemManifest() = default;
+
+	/** 在代码中（比如自动化测试）构造 Manifest 时使用，Fragment 之后通过 AddFragment 添加 */
+	FInv_ItemManifest(const EInv_ItemCategory InItemCategory, const FGameplayTag& InItemType)
+		: ItemCategory(InItemCategory), ItemType(InItemType)
+	{
+	}
+
+	/** Manifest 里有整个 Fragment 数组，拷贝代价不小，拷贝次数计入 STAT_Inv_ManifestCopies；尽量传 const 引用或者移动 */
+	FInv_ItemManifest(const FInv_ItemManifest& Other);
+	FInv_ItemManifest(FInv_ItemManifest&& Other) = default;
+	FInv_ItemManifest& operator=(const FInv_ItemManifest& Other);
+	FInv_ItemManifest& operator=(FInv_ItemManifest&& Other) = default;
+
+	/** 没有任何 Fragment 的 Manifest，查找不到道具时代替它返回 */
+	static const FInv_ItemManifest& GetEmpty();
+
+	/** 提供一个Manifest()方法，用于根据自身数据创建新的InventoryItem实例，道具持有 Manifest 的一份拷贝 */
+	UInv_InventoryItem* Manifest(UObject* NewOuter) const;
 	EInv_ItemCategory GetItemCategory() const { return ItemCategory; }
 	FGameplayTag GetItemType() const { return ItemType; }
 
@@ -32,10 +62,34 @@ public:
 	template <typename T> requires std::derived_from<T, FInv_ItemFragment>
 	T* GetMutableFragmentOfType();
 
+	/** 在末尾追加一个 T 类型的 Fragment，返回它以便继续设置 */
+	template <typename T> requires std::derived_from<T, FInv_ItemFragment>
+	T& AddFragment();
+
+	/** Fragments 被整体替换（比如网络复制写入、编辑器中修改）后调用，下次访问 Fragment 时会重新构建查找表 */
+	void InvalidateFragmentLookup() const;
+
+	void PostSerialize(const FArchive& Ar);
+
 private:
+	/**
+	 * 在查找表中找到第一个 Type 类型（且 FragmentTag 匹配，如果提供了的话）的 Fragment 的下标。
+	 * 查找表在第一次访问时构建，之后的访问不再需要对每个 Fragment 做 UScriptStruct 的 IsChildOf 检查。
+	 * 找到的项与 Fragments 中的实际类型对不上时说明查找表已经过期，会重新构建后再查一次。
+	 */
+	int32 FindFragmentIndex(const UScriptStruct* Type, const FGameplayTag* FragmentTag = nullptr) const;
+	int32 FindFragmentIndexInLookup(const UScriptStruct* Type, const FGameplayTag* FragmentTag, bool& bOutStale) const;
+	void BuildFragmentLookup() const;
+
 	UPROPERTY(EditAnywhere, Category="Inventory", meta=(ExcludeBaseStruct))
 	TArray<TInstancedStruct<FInv_ItemFragment>> Fragments;
 
+	/** Fragment 查找表，按 Type 排序以便二分查找，同一 Type 的项保持 Fragments 中的顺序；只是 Fragments 的缓存，不参与序列化与复制 */
+	mutable TArray<FInv_FragmentLookupEntry, TInlineAllocator<8>> FragmentLookup;
+
+	/** 构建查找表时 Fragments 的数量，用来发现查找表已经过期，INDEX_NONE 表示尚未构建 */
+	mutable int32 FragmentLookupSourceNum{INDEX_NONE};
+
 	UPROPERTY(EditAnywhere)
 	EInv_ItemCategory ItemCategory{EInv_ItemCategory::None};
 
@@ -43,42 +97,42 @@ private:
 	FGameplayTag ItemType;
 };
 
+template <>
+struct TStructOpsTypeTraits<FInv_ItemManifest> : public TStructOpsTypeTraitsBase2<FInv_ItemManifest>
+{
+	enum
+	{
+		// 反序列化后让 Fragment 查找表失效
+		WithPostSerialize = true
+	};
+};
+
 template <typename T> requires std::derived_from<T, FInv_ItemFragment>
 const T* FInv_ItemManifest::GetFragmentOfTypeWithTag(const FGameplayTag& FragmentTag) const
 {
-	for (const TInstancedStruct<FInv_ItemFragment>& Fragment : Fragments)
-	{
-		if (const T* FragmentPtr = Fragment.GetPtr<T>())
-		{
-			if (!FragmentPtr->GetFragmentTag().MatchesTagExact(FragmentTag)) continue;
-			return FragmentPtr;
-		}
-	}
-	return nullptr;
+	const int32 FragmentIndex = FindFragmentIndex(T::StaticStruct(), &FragmentTag);
+	return FragmentIndex != INDEX_NONE ? reinterpret_cast<const T*>(Fragments[FragmentIndex].GetMemory()) : nullptr;
 }
 
 template <typename T> requires std::derived_from<T, FInv_ItemFragment>
 const T* FInv_ItemManifest::GetFragmentOfType() const
 {
-	for (const TInstancedStruct<FInv_ItemFragment>& Fragment : Fragments)
-	{
-		if (const T* FragmentPtr = Fragment.GetPtr<T>())
-		{
-			return FragmentPtr;
-		}
-	}
-	return nullptr;
+	const int32 FragmentIndex = FindFragmentIndex(T::StaticStruct());
+	return FragmentIndex != INDEX_NONE ? reinterpret_cast<const T*>(Fragments[FragmentIndex].GetMemory()) : nullptr;
 }
 
 template <typename T> requires std::derived_from<T, FInv_ItemFragment>
 T* FInv_ItemManifest::GetMutableFragmentOfType()
 {
-	for (TInstancedStruct<FInv_ItemFragment>& Fragment : Fragments)
-	{
-		if (T* FragmentPtr = Fragment.GetMutablePtr<T>())
-		{
-			return FragmentPtr;
-		}
-	}
-	return nullptr;
+	const int32 FragmentIndex = FindFragmentIndex(T::StaticStruct());
+	return FragmentIndex != INDEX_NONE ? reinterpret_cast<T*>(Fragments[FragmentIndex].GetMutableMemory()) : nullptr;
+}
+
+template <typename T> requires std::derived_from<T, FInv_ItemFragment>
+T& FInv_ItemManifest::AddFragment()
+{
+	TInstancedStruct<FInv_ItemFragment>& Fragment = Fragments.AddDefaulted_GetRef();
+	Fragment.InitializeAs<T>();
+	InvalidateFragmentLookup();
+	return Fragment.template GetMutable<T>();
 }
@@ -22,19 +22,28 @@ class INVENTORY_API AInv_PlayerController : public APlayerController
 public:
 	AInv_PlayerController();
 
-	virtual void Tick(float DeltaSeconds) override;
-
 	UFUNCTION(BlueprintCallable)
 	void ToggleInventory();
 
+	bool IsInventoryMenuOpen() const;
+
+	/** 查找视点前方的 Pickup 并更新拾取提示，由 UInv_PickupSubsystem 按频率调度 */
+	void TraceForItem(const FVector& ViewLocation, const FRotator& ViewRotation);
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void SetupInputComponent() override;
 
 private:
 	void PrimaryInteract();
 	void CreateHUDWidget();
-	void TraceForItem();
+
+	/**
+	 * 从视点到 Pickup 做一次射线检测，确认没有被遮挡
+	 * @param TargetLocation 瞄准的位置，即视锥判断所用的包围盒中心，而不是常常贴着地面的 Actor 原点
+	 */
+	bool IsPickupVisible(const FVector& ViewLocation, const AActor* Pickup, const FVector& TargetLocation) const;
 
 	TWeakObjectPtr<UInv_InventoryComponent> InventoryComponent;
 
@@ -53,11 +62,21 @@ private:
 	UPROPERTY()
 	TObjectPtr<UInv_HUDWidget> HUDWidget;
 
+	/** 可以拾取的最远距离 */
 	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
 	float TraceLength;
 
+	/** 视锥半角（度），只有落在视锥内的 Pickup 才会成为目标 */
 	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
-	TEnumAsByte<ECollisionChannel> TraceChannel;
+	float TargetingConeAngle;
+
+	/** 遮挡检测使用的通道。项目的 Item 碰撞预设会阻挡 Visibility，射线先碰到 Pickup 本身时视为可见 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	TEnumAsByte<ECollisionChannel> OcclusionChannel;
+
+	/** 每次查找最多对几个候选做遮挡检测，按优先级依次检测，直到找到一个没有被遮挡的 */
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory", meta = (ClampMin = 1))
+	int32 MaxOcclusionTraces;
 
 	UPROPERTY()
 	TWeakObjectPtr<AActor> ThisActor;
@@ -1,9 +1,8 @@
 ﻿#pragma once
 
+#include "Types/Inv_ItemId.h"
 #include "Inv_GridTypes.generated.h"
 
-class UInv_InventoryItem;
-
 UENUM(BlueprintType)
 enum class EInv_ItemCategory: uint8
 {
@@ -13,6 +12,22 @@ enum class EInv_ItemCategory: uint8
 	None
 };
 
+/**
+ * 道具复制更新时具体变化了哪些内容
+ */
+UENUM(meta=(Bitflags, UseEnumValuesAsMaskValuesInEditor="true"))
+enum class EInv_ItemChangeFlags : uint8
+{
+	None = 0,
+	/** 道具的总堆叠数量 */
+	StackCount = 1 << 0,
+	/** 道具在网格中的锚点或锚点上的堆叠数量 */
+	Placements = 1 << 1,
+	/** 道具自己的 Manifest（写时复制后的 Fragment） */
+	Fragments = 1 << 2,
+};
+ENUM_CLASS_FLAGS(EInv_ItemChangeFlags)
+
 /**
  * 表示单个格子的信息。
  */
@@ -33,10 +48,13 @@ struct FInv_SlotAvailability
 	}
 
 	/** 格子索引 */
+	UPROPERTY()
 	int32 Index{INDEX_NONE};
 	/** 该格子要填充的物品数量 */
+	UPROPERTY()
 	int32 AmountToFill{0};
 	/** 格子中是否已有物品 */
+	UPROPERTY()
 	bool bItemAtIndex{false};
 };
 
@@ -52,18 +70,45 @@ struct FInv_SlotAvailabilityResult
 	{
 	}
 
-	/** 指向物品栏中已有的物品 */
-	TWeakObjectPtr<UInv_InventoryItem> Item;
+	/** 物品栏中已有的物品的 ID，没有时为空 ID */
+	UPROPERTY()
+	FInv_ItemId ItemId;
 	/** 当前可以放入的该物品数量 */
+	UPROPERTY()
 	int32 TotalRoomToFill{0};
 	/** 无法放入的物品数量 */
+	UPROPERTY()
 	int32 Remainder{0};
 	/** 是否可堆叠 */
+	UPROPERTY()
 	bool bStackable{false};
 	/** 具体格子的数据集合 */
+	UPROPERTY()
 	TArray<FInv_SlotAvailability> SlotAvailabilities;
 };
 
+/**
+ * 道具在网格中的一个锚点及该锚点上的堆叠数量，随 FastArray 条目一起复制
+ */
+USTRUCT()
+struct FInv_GridPlacement
+{
+	GENERATED_BODY()
+
+	/** 锚点（左上角）格子索引 */
+	UPROPERTY()
+	int32 Index{INDEX_NONE};
+
+	/** 锚点上的堆叠数量，不可堆叠的道具为 0 */
+	UPROPERTY()
+	int32 StackCount{0};
+};
+
+inline bool operator==(const FInv_GridPlacement& A, const FInv_GridPlacement& B)
+{
+	return A.Index == B.Index && A.StackCount == B.StackCount;
+}
+
 /**
  * 拖动开始时的鼠标位置象限，用于拖动道具时处理高亮
  */
@@ -111,8 +156,8 @@ struct FInv_SpaceQueryResult
 	// 这个单元格上有没有空间（有空间就是没道具）
 	bool bHasSpace{false};
 
-	// 这个单元格上没有空间的话，它上面的道具是否可以被交换？
-	TWeakObjectPtr<UInv_InventoryItem> ValidItem = nullptr;
+	// 这个单元格上没有空间的话，它上面可以被交换的道具的 ID，不能交换时为空 ID
+	FInv_ItemId ItemId;
 
 	// 上述道具可以被交换的话，它的锚点 Index 是什么？
 	int32 UpperLeftIndex{INDEX_NONE};
@@ -0,0 +1,54 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Inv_ItemId.generated.h"
+
+/**
+ * 道具实例 ID，由服务器在道具加入道具栏时分配，在所属道具栏的生命周期内不会重复使用。
+ * UI、RPC 与服务器网格模型都用它引用道具，不需要 NetGUID，也不需要验证弱指针。
+ * 网络上按变长整数发送，ID 较小时只占一两个字节。
+ */
+USTRUCT(BlueprintType)
+struct INVENTORY_API FInv_ItemId
+{
+	GENERATED_BODY()
+
+public:
+	FInv_ItemId() = default;
+
+	explicit FInv_ItemId(const uint64 InValue) : Value(InValue)
+	{
+	}
+
+	/** 0 表示没有道具 */
+	bool IsValid() const { return Value != 0; }
+	uint64 GetValue() const { return Value; }
+
+	/** 服务器分配下一个 ID */
+	FInv_ItemId Next() const { return FInv_ItemId(Value + 1); }
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FInv_ItemId& Other) const { return Value == Other.Value; }
+	bool operator!=(const FInv_ItemId& Other) const { return Value != Other.Value; }
+
+	friend uint32 GetTypeHash(const FInv_ItemId& ItemId) { return GetTypeHash(ItemId.Value); }
+
+	FString ToString() const { return LexToString(Value); }
+
+private:
+	UPROPERTY()
+	uint64 Value{0};
+};
+
+template <>
+struct TStructOpsTypeTraits<FInv_ItemId> : public TStructOpsTypeTraitsBase2<FInv_ItemId>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
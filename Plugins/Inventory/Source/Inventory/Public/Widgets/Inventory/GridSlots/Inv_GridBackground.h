@@ -0,0 +1,67 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "Widgets/Inventory/GridSlots/Inv_GridSlot.h"
+#include "Inv_GridBackground.generated.h"
+
+class SInv_GridBackground;
+
+/**
+ * 道具网格的背景，用一个控件画出所有格子，替代每格一个 UInv_GridSlot。
+ * 格子事件与 UInv_GridSlot 相同，格子 Index 由鼠标坐标算出。
+ */
+UCLASS()
+class INVENTORY_API UInv_GridBackground : public UWidget
+{
+	GENERATED_BODY()
+
+public:
+	virtual void SynchronizeProperties() override;
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+
+	void SetGridLayout(const int32 InRows, const int32 InColumns, const float InTileSize);
+
+	/** 使用格子 Widget 类上配置的笔刷，这样已有的格子样式不需要重新配置 */
+	void SetBrushesFrom(const UInv_GridSlot* GridSlotStyle);
+
+	void SetSlotState(const int32 Index, const EInv_GridSlotState State);
+	EInv_GridSlotState GetSlotState(const int32 Index) const;
+
+	FGridSlotEvent GridSlotClicked;
+	FGridSlotEvent GridSlotHovered;
+	FGridSlotEvent GridSlotUnhovered;
+
+protected:
+	virtual TSharedRef<SWidget> RebuildWidget() override;
+
+private:
+	void HandleCellClicked(int32 CellIndex, const FPointerEvent& MouseEvent);
+	void HandleCellHovered(int32 CellIndex, const FPointerEvent& MouseEvent);
+	void HandleCellUnhovered(int32 CellIndex, const FPointerEvent& MouseEvent);
+
+	const FSlateBrush& GetBrush(const EInv_GridSlotState State) const;
+
+	UPROPERTY(EditAnywhere, Category="Inventory")
+	FSlateBrush Brush_Unoccupied;
+
+	UPROPERTY(EditAnywhere, Category="Inventory")
+	FSlateBrush Brush_Occupied;
+
+	UPROPERTY(EditAnywhere, Category="Inventory")
+	FSlateBrush Brush_Selected;
+
+	UPROPERTY(EditAnywhere, Category="Inventory")
+	FSlateBrush Brush_GrayedOut;
+
+	int32 Rows{0};
+	int32 Columns{0};
+	float TileSize{0.f};
+
+	/** 每个格子的显示状态，Slate 控件重建时从这里恢复 */
+	TArray<EInv_GridSlotState> SlotStates;
+
+	TSharedPtr<SInv_GridBackground> MyGridBackground;
+};
@@ -6,7 +6,6 @@
 #include "Blueprint/UserWidget.h"
 #include "Inv_GridSlot.generated.h"
 
-class UInv_InventoryItem;
 class UImage;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGridSlotEvent, int32, GridIndex, const FPointerEvent&, MouseEvent);
@@ -42,14 +41,9 @@ public:
 	void SetTileIndex(const int32 Index) { TileIndex = Index; }
 	int32 GetTileIndex() const { return TileIndex; }
 	EInv_GridSlotState GetSlotState() const { return GridSlotState; }
-	TWeakObjectPtr<UInv_InventoryItem> GetInventoryItem() const { return InventoryItem; }
-	void SetInventoryItem(UInv_InventoryItem* Item);
-	int32 GetStackCount() const { return StackCount; }
-	void SetStackCount(const int32 Count) { StackCount = Count; }
-	int32 GetUpperLeftIndex() const { return UpperLeftIndex; }
-	void SetUpperLeftIndex(const int32 Index) { UpperLeftIndex = Index; }
-	bool IsAvailable() const { return bAvailable; }
-	void SetAvailable(const bool bIsAvailable) { bAvailable = bIsAvailable; }
+
+	/** 该状态下使用的笔刷，UInv_GridBackground 从这里读取格子样式 */
+	const FSlateBrush& GetBrush(const EInv_GridSlotState State) const;
 
 	FGridSlotEvent GridSlotClicked;
 	FGridSlotEvent GridSlotHovered;
@@ -57,19 +51,11 @@ public:
 
 private:
 	/**
-	 * 一个物品可能占据多个格子，要为这些格子设置相关的信息
-	 * - 堆叠数量
-	 * - 物品的左上角索引
-	 * - 物品的引用
-	 * - 格子可用性
+	 * 格子只负责显示，堆叠数量、锚点、道具引用、可用性等放置信息都保存在 FInv_SpatialGridModel 中
 	 */
 
 	/** * 该格子在网格中的索引 */
 	int32 TileIndex{INDEX_NONE};
-	int32 StackCount{0};
-	int32 UpperLeftIndex{INDEX_NONE};
-	TWeakObjectPtr<UInv_InventoryItem> InventoryItem;
-	bool bAvailable{true};
 
 	UPROPERTY(meta=(BindWidget))
 	TObjectPtr<UImage> Image_GridSlot;
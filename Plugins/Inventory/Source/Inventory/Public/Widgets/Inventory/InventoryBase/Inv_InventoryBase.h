@@ -8,6 +8,7 @@
 #include "Inv_InventoryBase.generated.h"
 
 class UInv_ItemComponent;
+struct FSlateDebuggingInvalidateArgs;
 
 /**
  * 
@@ -19,4 +20,23 @@ class INVENTORY_API UInv_InventoryBase : public UUserWidget
 
 public:
 	virtual FInv_SlotAvailabilityResult HasRoomForItem(UInv_ItemComponent* ItemComponent) const;
+
+	/**
+	 * 一次性为多个道具查找空间，结果与 ItemComponents 一一对应。
+	 * 后面的道具会考虑到前面的道具已经认领的格子。
+	 */
+	virtual TArray<FInv_SlotAvailabilityResult> HasRoomForItems(const TArray<UInv_ItemComponent*>& ItemComponents) const;
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+private:
+	/**
+	 * Inventory.TrackInvalidation 打开时，统计道具栏内每帧被失效的 Widget 数量（stat Inventory）。
+	 * 用来确认堆叠数量等数据变化只会让相关的 Widget 失效，而不是整个道具栏重新布局。
+	 */
+	void HandleWidgetInvalidated(const FSlateDebuggingInvalidateArgs& Args) const;
+
+	FDelegateHandle WidgetInvalidatedHandle;
 };
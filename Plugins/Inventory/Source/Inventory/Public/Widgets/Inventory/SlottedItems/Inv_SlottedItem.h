@@ -3,18 +3,23 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
 #include "Blueprint/UserWidget.h"
+#include "Items/Inv_ItemHandle.h"
 #include "Inv_SlottedItem.generated.h"
 
-class UInv_InventoryItem;
 class UImage;
 class UTextBlock;
+class UTexture2D;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FSlottedItemClicked,
                                              const int32, GridIndex,
                                              const FPointerEvent&, MouseEvent);
 
-UCLASS()
+/**
+ * 网格中的道具图标。不需要 Tick，内容只在数据变化时更新，这样在全局失效模式下不会让整个道具栏重新布局
+ */
+UCLASS(meta=(DisableNativeTick))
 class INVENTORY_API UInv_SlottedItem : public UUserWidget
 {
 	GENERATED_BODY()
@@ -29,10 +34,13 @@ public:
 	void SetGridIndex(const int32 InGridIndex) { this->GridIndex = InGridIndex; }
 	FIntPoint GetGridDimensions() const { return GridDimensions; }
 	void SetGridDimensions(const FIntPoint& InGridDimensions) { this->GridDimensions = InGridDimensions; }
-	UInv_InventoryItem* GetInventoryItem() const { return InventoryItem.Get(); }
-	void SetInventoryItem(UInv_InventoryItem* InInventoryItem);
+	const FInv_ItemHandle& GetInventoryItem() const { return InventoryItem; }
+	void SetInventoryItem(const FInv_ItemHandle& InInventoryItem);
 	void SetImageBrush(const FSlateBrush& Brush) const;
-	void UpdateStackCount(const int32 StackCount) const;
+	/** 设置图标，图标还没加载时先显示 Placeholder */
+	void SetIcon(const FGameplayTag& ItemType, const TSoftObjectPtr<UTexture2D>& Icon,
+	             const FVector2D& ImageSize, const FSlateBrush& Placeholder) const;
+	void UpdateStackCount(const int32 StackCount);
 
 	FSlottedItemClicked OnSlottedItemClicked;
 
@@ -45,7 +53,9 @@ private:
 
 	int32 GridIndex;
 	FIntPoint GridDimensions;
-	TWeakObjectPtr<UInv_InventoryItem> InventoryItem;
+	FInv_ItemHandle InventoryItem;
 	bool bIsStackable{false};
 
+	/** 当前显示的堆叠数量，INDEX_NONE 表示还没有显示过 */
+	int32 DisplayedStackCount{INDEX_NONE};
 };
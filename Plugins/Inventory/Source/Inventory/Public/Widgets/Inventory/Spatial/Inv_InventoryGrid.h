@@ -4,7 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
-#include "Items/Inv_InventoryItem.h"
+#include "Blueprint/UserWidgetPool.h"
+#include "InventoryManagement/Spatial/Inv_SpatialGridModel.h"
+#include "Items/Inv_ItemHandle.h"
 #include "Items/Fragments/Inv_ItemFragment.h"
 #include "Items/Manifest/Inv_ItemManifest.h"
 #include "Types/Inv_GridTypes.h"
@@ -17,82 +19,100 @@ class UInv_ItemComponent;
 class UInv_InventoryComponent;
 class UCanvasPanel;
 class UInv_GridSlot;
+class UInv_GridBackground;
 class UInv_HoverItem;
 enum class EInv_GridSlotState : uint8;
 
 /**
- * 道具网格
+ * 道具网格。悬停与拖动由鼠标事件驱动，不需要 Tick
  */
-UCLASS()
+UCLASS(meta=(DisableNativeTick))
 class INVENTORY_API UInv_InventoryGrid : public UUserWidget
 {
 	GENERATED_BODY()
 
 public:
+	UInv_InventoryGrid(const FObjectInitializer& ObjectInitializer);
+
 	virtual void NativeOnInitialized() override;
-	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+	virtual FReply NativeOnMouseMove(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent) override;
+	virtual void NativeOnMouseLeave(const FPointerEvent& InMouseEvent) override;
 
 	EInv_ItemCategory GetItemCategory() const { return ItemCategory; }
+	const FInv_SpatialGridModel& GetGridModel() const { return GridModel; }
 	FInv_SlotAvailabilityResult HasRoomForItem(const UInv_ItemComponent* ItemComponent);
 
 	void ShowCursor();
 	void HideCursor();
 
+	/**
+	 * 第一次显示网格时才创建 GridBackground 与 SlottedItem。
+	 * 在此之前只有 GridModel 会随道具变化更新，构建时再按它补上所有道具的显示。
+	 */
+	void EnsureGridConstructed();
+	bool IsGridConstructed() const { return bGridConstructed; }
+
 	UFUNCTION()
-	void AddItem(UInv_InventoryItem* Item);
+	void AddItem(const FInv_ItemHandle& Item);
 
 private:
 	void ConstructGrid();
-	bool MatchesCategory(const UInv_InventoryItem* Item) const;
-	FInv_SlotAvailabilityResult HasRoomForItem(const UInv_InventoryItem* Item);
+	/** 按 GridModel 为已有的道具创建 SlottedItem 并更新格子的显示 */
+	void PopulateFromModel();
+	bool MatchesCategory(const FInv_ItemHandle& Item) const;
+	/** 本道具栏中 ItemId 对应道具的句柄 */
+	FInv_ItemHandle GetItemHandle(const FInv_ItemId ItemId) const;
+	FInv_SlotAvailabilityResult HasRoomForItem(const FInv_ItemHandle& Item);
 	/** 在道具栏中查找所有可以给要添加的道具用的格子 */
 	FInv_SlotAvailabilityResult HasRoomForItem(const FInv_ItemManifest& Manifest);
-	void AddItemToIndices(const FInv_SlotAvailabilityResult& Result, UInv_InventoryItem* NewItem);
+	void AddItemToIndices(const FInv_SlotAvailabilityResult& Result, const FInv_ItemHandle& NewItem);
 	void SetSlottedItemImage(const UInv_SlottedItem* SlottedItem,
 	                         const FInv_GridFragment* GridFragment,
 	                         const FInv_ImageFragment* ImageFragment) const;
 	FVector2D GetDrawSize(const FInv_GridFragment* GridFragment) const;
-	void AddItemAtIndex(UInv_InventoryItem* Item, const int32 Index, const bool bStackable, const int32 StackAmount);
-	UInv_SlottedItem* CreateSlottedItem(UInv_InventoryItem* Item, const bool bStackable, const int32 StackAmount,
+	void AddItemAtIndex(const FInv_ItemHandle& Item, const int32 Index, const bool bStackable,
+	                    const int32 StackAmount);
+	UInv_SlottedItem* CreateSlottedItem(const FInv_ItemHandle& Item, const bool bStackable, const int32 StackAmount,
 	                                    const FInv_GridFragment* GridFragment, const FInv_ImageFragment* ImageFragment,
 	                                    const int32 Index);
+	/** 从对象池中取出/归还 SlottedItem */
+	UInv_SlottedItem* AcquireSlottedItem();
+	void ReleaseSlottedItem(UInv_SlottedItem* SlottedItem);
+
+	/** 从对象池中取出/归还 HoverItem */
+	UInv_HoverItem* AcquireHoverItem();
+	void ReleaseHoverItem(UInv_HoverItem* InHoverItem);
+
 	void AddSlottedItemToCanvas(const int32 Index, const FInv_GridFragment* GridFragment,
 	                            UInv_SlottedItem* SlottedItem) const;
-	void UpdateGridSlots(UInv_InventoryItem* NewItem, const int32 Index, bool bStackableItem, int32 StackAmount);
-	bool IsIndexClaimed(const TSet<int32>& Indices, const int32 Index) const;
-	bool HasRoomAtIndex(const UInv_GridSlot* GridSlot, const FIntPoint& Dimensions, const TSet<int32>& CheckedIndices,
-	                    TSet<int32>& OutTentativelyClaimed, const FGameplayTag& ItemType, const int32 StackMaxSize);
-	bool CheckSlotConstraints(const UInv_GridSlot* GridSlot, const UInv_GridSlot* SubGridSlot,
-	                          const TSet<int32>& CheckedIndices, TSet<int32>& OutTentativelyClaimed,
-	                          const FGameplayTag& ItemType, const int32 StackMaxSize) const;
-	FIntPoint GetItemDimensions(const FInv_ItemManifest& Manifest) const;
-	bool HasValidItem(const UInv_GridSlot* GridSlot) const;
-	bool IsUpperLeftSlot(const UInv_GridSlot* GridSlot, const UInv_GridSlot* SubGridSlot) const;
-	bool DoesItemTypeMatch(const UInv_InventoryItem* SubItem, const FGameplayTag& ItemType) const;
-	bool IsInGridBounds(const int32 StartIndex, const FIntPoint& ItemDimensions) const;
-	int32 DetermineFillAmountForSlot(const bool bStackable, const int32 MaxStackSize, const int32 AmountToFill,
-	                                 const UInv_GridSlot* GridSlot) const;
-	int32 GetStackAmount(const UInv_GridSlot* GridSlot) const;
+	void UpdateGridSlots(const FInv_ItemHandle& NewItem, const int32 Index, bool bStackableItem, int32 StackAmount);
 	bool IsRightClick(const FPointerEvent& MouseEvent) const;
 	bool IsLeftClick(const FPointerEvent& MouseEvent) const;
-	void PickUp(UInv_InventoryItem* ClickedInventoryItem, const int32 GridIndex);
+	void PickUp(const FInv_ItemHandle& ClickedInventoryItem, const int32 GridIndex);
 
 	/** 开始拖动道具时设置 HoverItem */
-	void AssignHoverItem(UInv_InventoryItem* InventoryItem, const int32 GridIndex, const int32 PreviousGridIndex);
+	void AssignHoverItem(const FInv_ItemHandle& InventoryItem, const int32 GridIndex, const int32 PreviousGridIndex);
 
 	/** 开始拖动道具时设置 HoverItem */
-	void AssignHoverItem(UInv_InventoryItem* InventoryItem);
+	void AssignHoverItem(const FInv_ItemHandle& InventoryItem);
 
-	void RemoveItemFromGrid(UInv_InventoryItem* InventoryItem, const int32 GridIndex);
+	void RemoveItemFromGrid(const FInv_ItemHandle& InventoryItem, const int32 GridIndex);
+
+	/** 记录鼠标在 Canvas 中的位置，拖动道具时更新 TileParameters */
+	void UpdateMousePosition(const FVector2D& ScreenPosition);
+
+	/** 开始拖动道具时鼠标可能还没动过，按上一次的鼠标位置刷新高亮 */
+	void RefreshHoverHighlight();
 
 	/** 计算瓦片的坐标系，用于处理网格插槽的高亮与否 */
-	void UpdateTileParameters(const FVector2D& CanvasPosition, const FVector2D& MousePosition);
+	void UpdateTileParameters(const FVector2D& InCanvasMousePosition, const bool bForceUpdate = false);
 
 	/** 算出鼠标落在哪一格 */
-	FIntPoint CalculateHoveredCoordinates(const FVector2D& CanvasPosition, const FVector2D& MousePosition) const;
+	FIntPoint CalculateHoveredCoordinates(const FVector2D& InCanvasMousePosition) const;
 
 	/** 计算鼠标位置在格子中的哪个象限上 */
-	EInv_TileQuadrant CalculateTileQuadrant(const FVector2D& CanvasPosition, const FVector2D& MousePosition) const;
+	EInv_TileQuadrant CalculateTileQuadrant(const FVector2D& InCanvasMousePosition) const;
 
 	/** TileParameter 更新时 */
 	void OnTileParameterUpdated(const FInv_TileParameters& Parameters);
@@ -104,17 +124,26 @@ private:
 	/** 检查拖动道具结束时要放置道具的目标单元格的可用性 */
 	FInv_SpaceQueryResult CheckHoverPosition(const FIntPoint& Position, const FIntPoint& Dimensions);
 
-	/** 鼠标退出画布时就不再需要计算了 */
-	bool CursorExitedCanvas(const FVector2D& BoundaryPos, const FVector2D& BoundarySize, const FVector2D& Location);
+	/** 鼠标退出画布时取消高亮，之后就不再需要计算了 */
+	void OnCursorExitedCanvas();
 
 	/** 鼠标悬停在可用或可置换单元格上时高亮格子 */
 	void HighLightSlots(const int32 Index, const FIntPoint& Dimensions);
 	/** 鼠标离开时取消高亮格子 */
-	void UnhighLightSlots(const int32 Index, const FIntPoint& Dimensions);
+	void UnhighLightSlots();
 
 	/** 改变鼠标悬停时的格子材质 */
 	void ChangeHoverType(const int32 Index, const FIntPoint& Dimensions, EInv_GridSlotState GridSlotState);
 
+	/**
+	 * 把高亮区域移动到新的位置：旧区域中不在新区域里的格子恢复为 GridModel 中的状态，
+	 * 新区域中的格子直接写成 GridSlotState，两个区域重叠的格子只写一次
+	 */
+	void SetHighlight(const int32 Index, const FIntPoint& Dimensions, const EInv_GridSlotState GridSlotState);
+
+	/** 按 GridModel 恢复格子的显示状态 */
+	void RestoreSlotState(const int32 TileIndex);
+
 	/** 将当前拖动的道具放下到指定的索引上 */
 	void PutDownOnIndex(const int32 Index);
 
@@ -125,10 +154,10 @@ private:
 	UUserWidget* GetHiddenCursorWidget();
 
 	/** 拖动道具并点击道具时，判断二者是否为同一类道具 */
-	bool IsSameStackable(const UInv_InventoryItem* ClickedInventoryItem) const;
+	bool IsSameStackable(const FInv_ItemHandle& ClickedInventoryItem) const;
 
 	/** 拖动道具，点击道具，并且二者可以交换时，交换二者 */
-	void SwapWithHoverItem(UInv_InventoryItem* ClickedInventoryItem, const int32 GridIndex);
+	void SwapWithHoverItem(const FInv_ItemHandle& ClickedInventoryItem, const int32 GridIndex);
 
 	bool ShouldSwapStackCounts(const int32 RoomInClickedSlot, const int32 HoveredStackCount,
 	                           const int32 MaxStackSize) const;
@@ -156,6 +185,34 @@ private:
 	UFUNCTION()
 	void AddStacks(const FInv_SlotAvailabilityResult& Result);
 
+	/** 服务器的放置结果与本地预测不一致时，撤销预测并应用服务器的结果 */
+	UFUNCTION()
+	void ReconcileStacks(const FInv_SlotAvailabilityResult& Predicted,
+	                     const FInv_SlotAvailabilityResult& Authoritative);
+
+	/** 道具离开道具栏（丢弃等）时移除它的所有锚点 */
+	UFUNCTION()
+	void RemoveItem(const FInv_ItemHandle& Item);
+
+	/** 处理道具的复制更新，只刷新变化的部分 */
+	UFUNCTION()
+	void OnItemChanged(const FInv_ItemHandle& Item, EInv_ItemChangeFlags ChangeFlags);
+
+	/**
+	 * 按复制下来的布局调整道具：只有堆叠数量变化的锚点只更新对应的 SlottedItem，
+	 * 消失的锚点移除，新出现的锚点添加
+	 */
+	void SyncItemPlacements(const FInv_ItemHandle& Item);
+
+	/** 道具的 Fragment 变化后刷新它所有 SlottedItem 的图标 */
+	void RefreshItemImages(const FInv_ItemHandle& Item);
+
+	/** 按布局把道具的每个锚点放进网格 */
+	void ApplyPlacements(const FInv_ItemHandle& Item, const TArray<FInv_GridPlacement>& Placements);
+
+	/** 本地拖放改变了布局后，把受影响的道具的布局发给服务器 */
+	void SendItemPlacements(const TArrayView<const FInv_ItemId> ItemIds);
+
 	/** 玩家按下道具栏中的道具时处理下拖动事件 */
 	UFUNCTION()
 	void OnSlottedItemClicked(int32 GridIndex, const FPointerEvent& MouseEvent);
@@ -187,17 +244,23 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(AllowPrivateAccess="true"), Category="Inventory")
 	EInv_ItemCategory ItemCategory;
 
+	/** 所有格子的背景，在一个控件中绘制 */
 	UPROPERTY()
-	TArray<TObjectPtr<UInv_GridSlot>> GridSlots;
+	TObjectPtr<UInv_GridBackground> GridBackground;
 
-	UPROPERTY(EditAnywhere, Category="Inventory")
-	TSubclassOf<UInv_GridSlot> GridSlotClass;
+	/** 网格的放置数据，GridSlots 只根据它来显示 */
+	FInv_SpatialGridModel GridModel;
 
-	UPROPERTY(EditAnywhere, Category="Inventory")
-	int32 Rows;
+	/** GridBackground 是否已经创建，未创建时所有的显示更新都会跳过 */
+	bool bGridConstructed{false};
 
+	/** 格子的样式，只读取它配置的笔刷，不再为每个格子创建 Widget */
 	UPROPERTY(EditAnywhere, Category="Inventory")
-	int32 Columns;
+	TSubclassOf<UInv_GridSlot> GridSlotClass;
+
+	/** 网格尺寸只在 InventoryComponent 的 GridSizes 中配置，初始化时从那里读取，保证与服务器的网格模型一致 */
+	int32 Rows{0};
+	int32 Columns{0};
 
 	UPROPERTY(EditAnywhere, Category="Inventory")
 	float TileSize;
@@ -205,9 +268,24 @@ private:
 	UPROPERTY(EditAnywhere, Category="Inventory")
 	TSubclassOf<UInv_HoverItem> HoverItemClass;
 
+	/** 道具图标异步加载完成之前显示的笔刷 */
+	UPROPERTY(EditAnywhere, Category="Inventory")
+	FSlateBrush IconPlaceholderBrush;
+
 	UPROPERTY()
 	TObjectPtr<UInv_HoverItem> HoverItem;
 
+	/** SlottedItem 与 HoverItem 的对象池，拖放和重新布局时复用 Widget，预热之后不再创建新的 UObject */
+	UPROPERTY(Transient)
+	FUserWidgetPool SlottedItemPool;
+
+	UPROPERTY(Transient)
+	FUserWidgetPool HoverItemPool;
+
+	/** 池中的 Widget 只会被复用而不会被销毁，活跃数量的历史最大值就是创建过的数量 */
+	int32 NumSlottedItemsCreated{0};
+	int32 NumHoverItemsCreated{0};
+
 	/** 用来处理鼠标拖动物体时的高亮等信息 */
 	FInv_TileParameters TileParameters;
 	FInv_TileParameters LastTileParameters;
@@ -216,9 +294,12 @@ private:
 	int32 ItemDropIndex{INDEX_NONE};
 	FInv_SpaceQueryResult CurrentQueryResult;
 
-	bool bMouseWithinCanvas;
-	bool bLastMouseWithinCanvas;
+	bool bMouseWithinCanvas{false};
+
+	/** 最近一次鼠标事件中鼠标在 Canvas 本地空间中的位置 */
+	FVector2D CanvasMousePosition{FVector2D::ZeroVector};
 
-	int32 LastHighlightedIndex;
-	FIntPoint LastHighlightedDimensions;
+	/** 当前高亮的区域 */
+	int32 LastHighlightedIndex{INDEX_NONE};
+	FIntPoint LastHighlightedDimensions{0, 0};
 };
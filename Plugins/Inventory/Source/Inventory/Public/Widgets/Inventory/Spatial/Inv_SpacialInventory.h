@@ -21,8 +21,12 @@ public:
 	virtual void NativeOnInitialized() override;
 
 	virtual FInv_SlotAvailabilityResult HasRoomForItem(UInv_ItemComponent* ItemComponent) const override;
+	virtual TArray<FInv_SlotAvailabilityResult> HasRoomForItems(
+		const TArray<UInv_ItemComponent*>& ItemComponents) const override;
 
 private:
+	UInv_InventoryGrid* GetGridForCategory(const EInv_ItemCategory Category) const;
+
 	UFUNCTION()
 	void ShowEquippables();
 
@@ -34,9 +38,22 @@ private:
 
 	void DisableButton(UButton* Button);
 	void SetActiveGrid(UInv_InventoryGrid* Grid, UButton* Button);
+
+	/**
+	 * 把网格包进一个 InvalidationBox，替换它在 Switcher 中的位置。
+	 * 网格内部的变化（堆叠数量、道具增减）只会让这个 InvalidationBox 重新缓存，不会让整个菜单重新布局。
+	 */
+	void WrapInInvalidationBox(UInv_InventoryGrid* Grid);
+
+	/** 网格在 Switcher 中对应的子 Widget：包了 InvalidationBox 时是 InvalidationBox，否则是网格本身 */
+	UWidget* GetSwitcherChild(UInv_InventoryGrid* Grid) const;
 	
 	TWeakObjectPtr<UInv_InventoryGrid> ActiveGrid;
 
+	/** 初始化时是否把各个网格包进 InvalidationBox；布局资产中已经包好的网格不会重复包装 */
+	UPROPERTY(EditDefaultsOnly, Category="Inventory")
+	bool bCacheGrids{true};
+
 	UPROPERTY(meta=(BindWidget))
 	TObjectPtr<UWidgetSwitcher> Switcher;
 
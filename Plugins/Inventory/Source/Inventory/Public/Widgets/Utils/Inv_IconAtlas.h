@@ -0,0 +1,58 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "GameplayTagContainer.h"
+#include "Inv_IconAtlas.generated.h"
+
+class UTexture2D;
+
+/**
+ * 一个道具图标在图集中的位置
+ */
+USTRUCT()
+struct FInv_IconAtlasRegion
+{
+	GENERATED_BODY()
+
+	/** 图集页在 UInv_IconAtlas::Pages 中的下标 */
+	UPROPERTY(VisibleAnywhere, Category="Inventory")
+	int32 PageIndex{INDEX_NONE};
+
+	/** 图标在图集页中的 UV 范围（0~1） */
+	UPROPERTY(VisibleAnywhere, Category="Inventory")
+	FVector2D UVMin{FVector2D::ZeroVector};
+
+	UPROPERTY(VisibleAnywhere, Category="Inventory")
+	FVector2D UVMax{FVector2D::ZeroVector};
+};
+
+/**
+ * 道具图标图集，由 InventoryEditor 模块的 Inv_IconAtlas 命令行工具从所有道具定义的 FInv_ImageFragment 烘焙生成。
+ * 同一页上的图标共享一张贴图，整个网格的图标可以合并成很少的绘制批次。
+ */
+UCLASS()
+class INVENTORY_API UInv_IconAtlas : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	/** 道具类型对应的图集区域，道具没有被烘焙进图集时返回 nullptr */
+	const FInv_IconAtlasRegion* FindRegion(const FGameplayTag& ItemType) const { return Regions.Find(ItemType); }
+
+	const TSoftObjectPtr<UTexture2D>& GetPage(const int32 PageIndex) const { return Pages[PageIndex]; }
+	bool IsValidPage(const int32 PageIndex) const { return Pages.IsValidIndex(PageIndex); }
+
+#if WITH_EDITOR
+	void SetAtlasData(TArray<TSoftObjectPtr<UTexture2D>>&& InPages, TMap<FGameplayTag, FInv_IconAtlasRegion>&& InRegions);
+#endif
+
+private:
+	UPROPERTY(VisibleAnywhere, Category="Inventory")
+	TArray<TSoftObjectPtr<UTexture2D>> Pages;
+
+	UPROPERTY(VisibleAnywhere, Category="Inventory")
+	TMap<FGameplayTag, FInv_IconAtlasRegion> Regions;
+};
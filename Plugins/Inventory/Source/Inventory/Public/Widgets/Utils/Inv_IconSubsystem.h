@@ -0,0 +1,81 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "GameplayTagContainer.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Inv_IconSubsystem.generated.h"
+
+struct FStreamableHandle;
+class UImage;
+class UInv_IconAtlas;
+class UTexture2D;
+
+/**
+ * 道具图标的异步加载与缓存。
+ * FInv_ImageFragment 只保存图标的软引用，图标在 SlottedItem/HoverItem 需要显示时才通过 StreamableManager 加载，
+ * 最近使用过的图标保存在 LRU 中，超出容量时释放最久没用过的图标。
+ * 配置了 IconAtlas 时优先使用图集中的区域，同一页上的图标共享贴图。
+ */
+UCLASS(Config=Game)
+class INVENTORY_API UInv_IconSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	static UInv_IconSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * 给 Image 设置图标。图标已经加载时立即显示，否则先显示 Placeholder，加载完成后再替换。
+	 * 同一个 Image 只会应用最后一次请求的图标，复用的 Widget 不会被之前的请求覆盖。
+	 * @param ItemType 用来在图集中查找图标，没有烘焙进图集的道具使用 Icon 本身
+	 */
+	static void SetImageIcon(const UObject* WorldContextObject, UImage* Image, const FGameplayTag& ItemType,
+	                         const TSoftObjectPtr<UTexture2D>& Icon, const FVector2D& ImageSize,
+	                         const FSlateBrush& Placeholder);
+
+	/** 取消 Image 尚未完成的图标请求，Image 要显示别的内容时调用 */
+	static void CancelImageIcon(const UObject* WorldContextObject, UImage* Image);
+
+private:
+	/**
+	 * @param UVRegion 图标在贴图中的范围，无效时使用整张贴图
+	 */
+	void RequestImageIcon(UImage* Image, const TSoftObjectPtr<UTexture2D>& Icon, const FBox2f& UVRegion,
+	                      const FVector2D& ImageSize, const FSlateBrush& Placeholder);
+	void OnIconLoaded(FSoftObjectPath IconPath);
+
+	static void ApplyIcon(UImage* Image, UTexture2D* Icon, const FVector2D& ImageSize, const FBox2f& UVRegion);
+
+	/** 烘焙好的图标图集，可选 */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UInv_IconAtlas> IconAtlas;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UInv_IconAtlas> LoadedIconAtlas;
+
+	/** 最多保持多少个最近使用过的图标常驻内存 */
+	UPROPERTY(Config)
+	int32 MaxCachedIcons{128};
+
+	/** 最近使用过的图标，持有 Handle 让它们保持加载 */
+	TLruCache<FSoftObjectPath, TSharedPtr<FStreamableHandle>> LoadedIcons;
+
+	/** 正在加载的图标 */
+	TMap<FSoftObjectPath, TSharedPtr<FStreamableHandle>> LoadingIcons;
+
+	struct FPendingImage
+	{
+		FSoftObjectPath IconPath;
+		FVector2D ImageSize;
+		FBox2f UVRegion;
+	};
+
+	/** 等待图标加载完成的 Image */
+	TMap<TWeakObjectPtr<UImage>, FPendingImage> PendingImages;
+};
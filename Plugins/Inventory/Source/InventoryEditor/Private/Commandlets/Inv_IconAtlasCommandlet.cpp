@@ -0,0 +1,261 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/Inv_IconAtlasCommandlet.h"
+
+#include "InventoryEditor.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/Texture2D.h"
+#include "ImageCore.h"
+#include "Items/Definition/Inv_ItemDefinition.h"
+#include "Items/Fragments/Inv_ItemFragment.h"
+#include "Misc/PackageName.h"
+#include "UObject/SavePackage.h"
+#include "Widgets/Utils/Inv_IconAtlas.h"
+
+namespace Inv_IconAtlas
+{
+	/** 一个要打包的图标 */
+	struct FAtlasIcon
+	{
+		TObjectPtr<UTexture2D> Texture;
+		TArray<FGameplayTag> ItemTypes;
+		FImage Pixels;
+		int32 PageIndex{INDEX_NONE};
+		FIntPoint Position{0, 0};
+	};
+
+	void GatherIcons(TArray<FAtlasIcon>& OutIcons)
+	{
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+		AssetRegistry.SearchAllAssets(true);
+
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByClass(UInv_ItemDefinition::StaticClass()->GetClassPathName(), Assets, true);
+
+		for (const FAssetData& AssetData : Assets)
+		{
+			const UInv_ItemDefinition* Definition = Cast<UInv_ItemDefinition>(AssetData.GetAsset());
+			if (!Definition) continue;
+
+			const FInv_ItemManifest& Manifest = Definition->GetItemManifest();
+			const FInv_ImageFragment* ImageFragment = Manifest.GetFragmentOfType<FInv_ImageFragment>();
+			if (!ImageFragment || ImageFragment->GetIcon().IsNull()) continue;
+
+			UTexture2D* Texture = ImageFragment->GetIcon().LoadSynchronous();
+			if (!Texture || !Texture->Source.IsValid())
+			{
+				UE_LOG(LogInventoryEditor, Warning, TEXT("%s: icon has no source data, skipped."),
+				       *AssetData.GetObjectPathString())
+				continue;
+			}
+
+			// 多个道具类型共用同一张图标时只打包一次
+			if (FAtlasIcon* Existing = OutIcons.FindByPredicate([Texture](const FAtlasIcon& Icon)
+			{
+				return Icon.Texture == Texture;
+			}))
+			{
+				Existing->ItemTypes.AddUnique(Manifest.GetItemType());
+				continue;
+			}
+
+			FImage SourceImage;
+			if (!Texture->Source.GetMipImage(SourceImage, 0, 0, 0))
+			{
+				UE_LOG(LogInventoryEditor, Warning, TEXT("%s: failed to read icon %s, skipped."),
+				       *AssetData.GetObjectPathString(), *Texture->GetPathName())
+				continue;
+			}
+
+			FAtlasIcon& Icon = OutIcons.AddDefaulted_GetRef();
+			Icon.Texture = Texture;
+			Icon.ItemTypes.Add(Manifest.GetItemType());
+			SourceImage.CopyTo(Icon.Pixels, ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+		}
+	}
+
+	/**
+	 * 按高度从大到小逐行（Shelf）放置图标，放不下时换页
+	 * @return 页数
+	 */
+	int32 PackIcons(TArray<FAtlasIcon>& Icons, const int32 PageSize, const int32 Padding)
+	{
+		Icons.Sort([](const FAtlasIcon& A, const FAtlasIcon& B)
+		{
+			return A.Pixels.SizeY > B.Pixels.SizeY;
+		});
+
+		int32 NumPages = 0;
+		int32 CursorX = 0;
+		int32 CursorY = 0;
+		int32 ShelfHeight = 0;
+		for (FAtlasIcon& Icon : Icons)
+		{
+			const int32 Width = Icon.Pixels.SizeX + Padding;
+			const int32 Height = Icon.Pixels.SizeY + Padding;
+			if (Width > PageSize || Height > PageSize)
+			{
+				UE_LOG(LogInventoryEditor, Warning, TEXT("Icon %s (%dx%d) does not fit in a %d page, skipped."),
+				       *Icon.Texture->GetPathName(), Icon.Pixels.SizeX, Icon.Pixels.SizeY, PageSize)
+				continue;
+			}
+
+			if (NumPages == 0)
+			{
+				NumPages = 1;
+			}
+			if (CursorX + Width > PageSize)
+			{
+				CursorX = 0;
+				CursorY += ShelfHeight;
+				ShelfHeight = 0;
+			}
+			if (CursorY + Height > PageSize)
+			{
+				++NumPages;
+				CursorX = 0;
+				CursorY = 0;
+				ShelfHeight = 0;
+			}
+
+			Icon.PageIndex = NumPages - 1;
+			Icon.Position = FIntPoint(CursorX + Padding / 2, CursorY + Padding / 2);
+			CursorX += Width;
+			ShelfHeight = FMath::Max(ShelfHeight, Height);
+		}
+		return NumPages;
+	}
+
+	bool SaveAsset(UObject* Asset)
+	{
+		UPackage* Package = Asset->GetPackage();
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(),
+		                                                                 FPackageName::GetAssetPackageExtension());
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		SaveArgs.SaveFlags = SAVE_NoError;
+		return UPackage::SavePackage(Package, Asset, *Filename, SaveArgs);
+	}
+
+	template <typename AssetT>
+	AssetT* FindOrCreateAsset(const FString& PackageName)
+	{
+		UPackage* Package = CreatePackage(*PackageName);
+		Package->FullyLoad();
+
+		const FString AssetName = FPackageName::GetShortName(PackageName);
+		if (AssetT* Existing = FindObject<AssetT>(Package, *AssetName))
+		{
+			return Existing;
+		}
+
+		AssetT* Asset = NewObject<AssetT>(Package, *AssetName, RF_Public | RF_Standalone);
+		FAssetRegistryModule::AssetCreated(Asset);
+		return Asset;
+	}
+
+	UTexture2D* WritePage(const FString& PackageName, const TArray<FAtlasIcon>& Icons, const int32 PageIndex,
+	                      const int32 PageSize)
+	{
+		TArray<FColor> PagePixels;
+		PagePixels.Init(FColor::Transparent, PageSize * PageSize);
+		for (const FAtlasIcon& Icon : Icons)
+		{
+			if (Icon.PageIndex != PageIndex) continue;
+
+			const TArrayView64<const FColor> Source = Icon.Pixels.AsBGRA8();
+			for (int32 Row = 0; Row < Icon.Pixels.SizeY; ++Row)
+			{
+				FMemory::Memcpy(&PagePixels[(Icon.Position.Y + Row) * PageSize + Icon.Position.X],
+				                &Source[static_cast<int64>(Row) * Icon.Pixels.SizeX],
+				                Icon.Pixels.SizeX * sizeof(FColor));
+			}
+		}
+
+		UTexture2D* Page = FindOrCreateAsset<UTexture2D>(PackageName);
+		Page->PreEditChange(nullptr);
+		Page->Source.Init(PageSize, PageSize, 1, 1, TSF_BGRA8, reinterpret_cast<const uint8*>(PagePixels.GetData()));
+		Page->SRGB = true;
+		Page->CompressionSettings = TC_EditorIcon;
+		Page->LODGroup = TEXTUREGROUP_UI;
+		Page->MipGenSettings = TMGS_NoMipmaps;
+		Page->PostEditChange();
+		return Page;
+	}
+}
+
+UInv_IconAtlasCommandlet::UInv_IconAtlasCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Packs the icons of all item definitions into texture atlases.");
+	HelpUsage = TEXT("-run=Inv_IconAtlas -Atlas=/Game/Path/DA_IconAtlas [-PageSize=2048] [-Padding=2]");
+}
+
+int32 UInv_IconAtlasCommandlet::Main(const FString& Params)
+{
+	using namespace Inv_IconAtlas;
+
+	FString AtlasPackageName;
+	if (!FParse::Value(*Params, TEXT("Atlas="), AtlasPackageName) ||
+		!FPackageName::IsValidLongPackageName(AtlasPackageName))
+	{
+		UE_LOG(LogInventoryEditor, Error, TEXT("Usage: %s"), *HelpUsage)
+		return 1;
+	}
+
+	int32 PageSize = 2048;
+	int32 Padding = 2;
+	FParse::Value(*Params, TEXT("PageSize="), PageSize);
+	FParse::Value(*Params, TEXT("Padding="), Padding);
+	PageSize = FMath::Max(PageSize, 64);
+	Padding = FMath::Max(Padding, 0);
+
+	TArray<FAtlasIcon> Icons;
+	GatherIcons(Icons);
+	const int32 NumPages = PackIcons(Icons, PageSize, Padding);
+
+	TArray<TSoftObjectPtr<UTexture2D>> Pages;
+	for (int32 PageIndex = 0; PageIndex < NumPages; ++PageIndex)
+	{
+		UTexture2D* Page = WritePage(FString::Printf(TEXT("%s_Page%d"), *AtlasPackageName, PageIndex), Icons,
+		                             PageIndex, PageSize);
+		if (!SaveAsset(Page))
+		{
+			UE_LOG(LogInventoryEditor, Error, TEXT("Failed to save atlas page %s."), *Page->GetPathName())
+			return 1;
+		}
+		Pages.Add(Page);
+	}
+
+	TMap<FGameplayTag, FInv_IconAtlasRegion> Regions;
+	for (const FAtlasIcon& Icon : Icons)
+	{
+		if (Icon.PageIndex == INDEX_NONE) continue;
+
+		FInv_IconAtlasRegion Region;
+		Region.PageIndex = Icon.PageIndex;
+		Region.UVMin = FVector2D(Icon.Position) / PageSize;
+		Region.UVMax = FVector2D(Icon.Position + FIntPoint(Icon.Pixels.SizeX, Icon.Pixels.SizeY)) / PageSize;
+		for (const FGameplayTag& ItemType : Icon.ItemTypes)
+		{
+			Regions.Add(ItemType, Region);
+		}
+	}
+
+	UInv_IconAtlas* Atlas = FindOrCreateAsset<UInv_IconAtlas>(AtlasPackageName);
+	Atlas->SetAtlasData(MoveTemp(Pages), MoveTemp(Regions));
+	if (!SaveAsset(Atlas))
+	{
+		UE_LOG(LogInventoryEditor, Error, TEXT("Failed to save icon atlas %s."), *Atlas->GetPathName())
+		return 1;
+	}
+
+	UE_LOG(LogInventoryEditor, Display, TEXT("Packed %d icons into %d atlas page(s) for %s."), Icons.Num(), NumPages,
+	       *AtlasPackageName)
+	return 0;
+}
@@ -0,0 +1,19 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "InventoryEditor.h"
+
+#define LOCTEXT_NAMESPACE "FInventoryEditorModule"
+
+DEFINE_LOG_CATEGORY(LogInventoryEditor);
+
+void FInventoryEditorModule::StartupModule()
+{
+}
+
+void FInventoryEditorModule::ShutdownModule()
+{
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FInventoryEditorModule, InventoryEditor)
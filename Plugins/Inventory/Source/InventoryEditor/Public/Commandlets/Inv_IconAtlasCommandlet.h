@@ -0,0 +1,25 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "Inv_IconAtlasCommandlet.generated.h"
+
+/**
+ * 把所有道具定义（UInv_ItemDefinition）的 FInv_ImageFragment 图标打包成图集，并写入 UInv_IconAtlas 资产。
+ * 运行时把该资产配置给 UInv_IconSubsystem::IconAtlas，道具图标就会从图集中取用。
+ *
+ * 用法：UnrealEditor-Cmd <Project>.uproject -run=Inv_IconAtlas -Atlas=/Game/Path/DA_IconAtlas [-PageSize=2048] [-Padding=2]
+ * 图集页保存在 Atlas 旁边，命名为 <Atlas>_Page<N>。
+ */
+UCLASS()
+class INVENTORYEDITOR_API UInv_IconAtlasCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UInv_IconAtlasCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};